@@ -0,0 +1,161 @@
+// *******************************************************************
+// * bench-binding.c
+// *
+// * Duplicate check of a remote's clusters against the binding table:
+// * the former scan with emberGetBinding for every cluster vs lookups
+// * in the plugin's RAM mirror of the table. Misses of new remotes cost
+// * no reads only when binding changes are reported to the plugin,
+// * otherwise the mirror scans the table for them as well
+// *
+// *******************************************************************
+
+#include <stdio.h>
+
+#include "ember-host.h"
+#include "sc-bench.h"
+#include "simple-commissioning-initiator-binding.h"
+
+#define LOCAL_EP 1
+#define REMOTE_EP 1
+/// Clusters a remote offers for binding
+#define REMOTE_CLUSTERS 8
+/// Remotes checked per table size and method
+#define DEVICES 256
+
+static const uint16_t table_sizes[] = {32, 128, 1024};
+
+/*! \typedef struct BenchResult
+    \brief Cost of checking one remote
+*/
+typedef struct BenchResult {
+  double reads;
+  double ns;
+} BenchResult_t;
+
+static void RandomEui64(EmberEUI64 eui64) {
+  for (uint8_t i = 0; i < EUI64_SIZE; ++i) {
+    eui64[i] = (uint8_t)HostRandom();
+  }
+}
+
+static void MakeKey(const EmberEUI64 eui64, uint16_t cluster_id,
+                    EmberBindingTableEntry *entry) {
+  *entry = (EmberBindingTableEntry){.type = EMBER_UNICAST_BINDING,
+                                    .local = LOCAL_EP,
+                                    .clusterId = cluster_id,
+                                    .remote = REMOTE_EP};
+  MEMCOPY(entry->identifier, eui64, EUI64_SIZE);
+}
+
+/// Fill the whole table with bindings to random remotes
+static void FillBindingTable(void) {
+  EmberBindingTableEntry entry;
+  EmberEUI64 eui64;
+
+  for (uint16_t i = 0; i < emberBindingTableSize; ++i) {
+    RandomEui64(eui64);
+    MakeKey(eui64, (uint16_t)(HostRandom() % 0x10), &entry);
+    emberSetBinding(i, &entry);
+  }
+}
+
+/// The plugin's duplicate check before the mirror
+static uint16_t ScanForBinding(const EmberBindingTableEntry *key) {
+  EmberBindingTableEntry entry = {0};
+
+  for (uint16_t i = 0; i < emberBindingTableSize; ++i) {
+    if (emberGetBinding(i, &entry) != EMBER_SUCCESS) {
+      break;
+    }
+    if (entry.type != EMBER_UNUSED_BINDING && entry.local == key->local &&
+        entry.clusterId == key->clusterId && entry.remote == key->remote &&
+        MEMCOMPARE(entry.identifier, key->identifier, EUI64_SIZE) == 0) {
+      return i;
+    }
+  }
+
+  return BINDING_NOT_FOUND;
+}
+
+/// Check DEVICES remotes, new ones (not bound yet) or already bound
+/// ones, with @find
+static BenchResult_t CheckDevices(bool bound,
+                                  uint16_t (*find)(
+                                      const EmberBindingTableEntry *const)) {
+  static EmberBindingTableEntry keys[DEVICES][REMOTE_CLUSTERS];
+  EmberBindingTableEntry entry;
+  uint32_t found = 0;
+
+  for (uint32_t d = 0; d < DEVICES; ++d) {
+    EmberEUI64 eui64;
+    RandomEui64(eui64);
+    for (uint16_t c = 0; c < REMOTE_CLUSTERS; ++c) {
+      if (bound) {
+        emberGetBinding((uint16_t)(HostRandom() % emberBindingTableSize),
+                        &entry);
+        keys[d][c] = entry;
+      } else {
+        MakeKey(eui64, (uint16_t)(0x100 + c), &keys[d][c]);
+      }
+    }
+  }
+
+  uint32_t reads = HostGetStats()->binding_reads;
+  uint64_t started = BenchNowNs();
+
+  for (uint32_t d = 0; d < DEVICES; ++d) {
+    for (uint16_t c = 0; c < REMOTE_CLUSTERS; ++c) {
+      found += (find(&keys[d][c]) != BINDING_NOT_FOUND) ? 1 : 0;
+    }
+  }
+
+  uint64_t elapsed = BenchNowNs() - started;
+  if (found != (bound ? DEVICES * REMOTE_CLUSTERS : 0)) {
+    printf("  unexpected lookup results: %u\n", found);
+  }
+
+  return (BenchResult_t){
+      .reads = (double)(HostGetStats()->binding_reads - reads) / DEVICES,
+      .ns = (double)elapsed / DEVICES};
+}
+
+void BenchBindingDuplicates(void) {
+  printf("%u clusters per remote, cost per remote\n", REMOTE_CLUSTERS);
+#ifdef EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_BINDING_CHANGES_REPORTED
+  printf("binding changes reported: mirror misses are trusted\n");
+#else
+  printf("binding changes not reported: mirror misses scan the table\n");
+#endif
+  printf("%6s %-8s %14s %12s %14s %12s\n", "table", "method", "new: reads",
+         "new: ns", "bound: reads", "bound: ns");
+
+  for (size_t i = 0; i < COUNTOF(table_sizes); ++i) {
+    HostConfig_t config;
+    HostDefaultConfig(&config);
+    config.binding_table_size = table_sizes[i];
+    HostInit(&config);
+    FillBindingTable();
+
+    BenchResult_t scan_new = CheckDevices(false, ScanForBinding);
+    BenchResult_t scan_bound = CheckDevices(true, ScanForBinding);
+
+    uint32_t reads = HostGetStats()->binding_reads;
+    uint64_t started = BenchNowNs();
+    InitBindingMirror();
+    uint64_t init_ns = BenchNowNs() - started;
+    reads = HostGetStats()->binding_reads - reads;
+
+    BenchResult_t mirror_new = CheckDevices(false, FindBinding);
+    BenchResult_t mirror_bound = CheckDevices(true, FindBinding);
+
+    printf("%6u %-8s %14.1f %12.0f %14.1f %12.0f\n", table_sizes[i], "scan",
+           scan_new.reads, scan_new.ns, scan_bound.reads, scan_bound.ns);
+    printf("%6u %-8s %14.1f %12.0f %14.1f %12.0f\n", table_sizes[i], "mirror",
+           mirror_new.reads, mirror_new.ns, mirror_bound.reads,
+           mirror_bound.ns);
+    printf("%6s mirror build per session: %u reads, %.0f ns\n", "", reads,
+           (double)init_ns);
+  }
+
+  HostDeinit();
+}
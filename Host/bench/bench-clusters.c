@@ -0,0 +1,188 @@
+// *******************************************************************
+// * bench-clusters.c
+// *
+// * Matching of a remote's clusters against the local clusters list:
+// * the former nested loop vs the matcher prepared once per session vs
+// * reusing the match result of an identical remote (same model)
+// *
+// *******************************************************************
+
+#include <stdio.h>
+
+#include "ember-host.h"
+#include "sc-bench.h"
+#include "simple-commissioning-initiator-bits.h"
+#include "simple-commissioning-initiator-clusters.h"
+
+/// Clusters in a remote's simple descriptor
+#define REMOTE_CLUSTERS 32
+/// Remotes matched per local list length and method
+#define DEVICES 4096
+/// Distinct models among remotes for the match results reuse
+#define MODELS 4
+
+static const uint8_t local_lengths[] = {4, 16, 64, 255};
+
+static uint16_t local_clusters[255];
+static uint16_t remote_clusters[DEVICES][REMOTE_CLUSTERS];
+
+/// The plugin's matching before the matcher
+static uint8_t NestedLoopMatch(const uint16_t *incoming, uint8_t incoming_len,
+                               const uint16_t *local, uint8_t local_len) {
+  uint8_t supported = 0;
+
+  for (size_t i = 0; i < incoming_len; ++i) {
+    for (size_t j = 0; j < local_len; ++j) {
+      if (incoming[i] == local[j]) {
+        ++supported;
+        break;
+      }
+    }
+  }
+
+  return supported;
+}
+
+static uint8_t MatcherMatch(const uint16_t *incoming, uint8_t incoming_len,
+                            const ClusterMatcher_t *matcher) {
+  uint8_t supported = 0;
+
+  for (size_t i = 0; i < incoming_len; ++i) {
+    supported += (FindLocalCluster(matcher, incoming[i], SC_ROLE_CLIENT) !=
+                  CLUSTER_NOT_FOUND)
+                     ? 1
+                     : 0;
+  }
+
+  return supported;
+}
+
+/// Number of distinct local clusters among @incoming, the way match
+/// results count them
+static uint8_t DistinctMatch(const uint16_t *incoming, uint8_t incoming_len,
+                             const ClusterMatcher_t *matcher) {
+  uint32_t mask[LOCAL_CLUSTERS_MASK_WORDS] = {0};
+  uint8_t supported = 0;
+
+  for (size_t i = 0; i < incoming_len; ++i) {
+    uint8_t pos = FindLocalCluster(matcher, incoming[i], SC_ROLE_CLIENT);
+    if (pos != CLUSTER_NOT_FOUND) {
+      mask[pos / 32] |= 1UL << (pos % 32);
+    }
+  }
+  for (uint8_t word = 0; word < LOCAL_CLUSTERS_MASK_WORDS; ++word) {
+    supported += CountSetBits(mask[word]);
+  }
+
+  return supported;
+}
+
+/// The plugin's matching with match results reuse, stores supported
+/// clusters in @supported_mask (a bit per matcher's position)
+static uint8_t ModelMatch(const uint16_t *incoming, uint8_t incoming_len,
+                          const ClusterMatcher_t *matcher,
+                          MatchResults_t *results, uint32_t *supported_mask) {
+  EmberAfClusterList clusters = {.inClusterCount = incoming_len,
+                                 .inClusterList = incoming,
+                                 .profileId = 0x0104};
+  uint32_t fingerprint = GetDescriptorFingerprint(&clusters);
+  const MatchResult_t *result =
+      FindMatchResult(results, fingerprint, &clusters);
+  uint8_t supported = 0;
+
+  if (result != NULL) {
+    MEMCOPY(supported_mask, result->clusters, sizeof(result->clusters));
+  } else {
+    MEMSET(supported_mask, 0, sizeof(result->clusters));
+    for (size_t i = 0; i < incoming_len; ++i) {
+      uint8_t pos = FindLocalCluster(matcher, incoming[i], SC_ROLE_CLIENT);
+      if (pos != CLUSTER_NOT_FOUND) {
+        supported_mask[pos / 32] |= 1UL << (pos % 32);
+      }
+    }
+    StoreMatchResult(results, fingerprint, &clusters, supported_mask);
+  }
+
+  for (uint8_t word = 0; word < LOCAL_CLUSTERS_MASK_WORDS; ++word) {
+    supported += CountSetBits(supported_mask[word]);
+  }
+
+  return supported;
+}
+
+/// Local clusters are distinct, about a half of remote clusters match
+static void MakeClusters(uint8_t local_len) {
+  for (uint16_t i = 0; i < local_len; ++i) {
+    local_clusters[i] = (uint16_t)(i * 16 + HostRandom() % 16);
+  }
+  for (uint32_t d = 0; d < DEVICES; ++d) {
+    for (uint8_t c = 0; c < REMOTE_CLUSTERS; ++c) {
+      remote_clusters[d][c] = (HostRandom() & 1)
+                                  ? local_clusters[HostRandom() % local_len]
+                                  : (uint16_t)(0x8000 + HostRandom() % 0x8000);
+    }
+  }
+}
+
+void BenchClusterMatching(void) {
+  static ClusterMatcher_t matcher;
+  static MatchResults_t results;
+  uint32_t supported_mask[LOCAL_CLUSTERS_MASK_WORDS];
+
+  printf("%u clusters per remote, cost per remote\n", REMOTE_CLUSTERS);
+  printf("%6s %12s %12s %12s %12s\n", "local", "loop: ns", "matcher: ns",
+         "prepare: ns", "models: ns");
+
+  HostInit(NULL);
+  for (size_t i = 0; i < COUNTOF(local_lengths); ++i) {
+    uint8_t local_len = local_lengths[i];
+    uint32_t loop_matched = 0;
+    uint32_t matcher_matched = 0;
+
+    MakeClusters(local_len);
+
+    uint64_t started = BenchNowNs();
+    for (uint32_t d = 0; d < DEVICES; ++d) {
+      loop_matched += NestedLoopMatch(remote_clusters[d], REMOTE_CLUSTERS,
+                                      local_clusters, local_len);
+    }
+    uint64_t loop_ns = BenchNowNs() - started;
+
+    started = BenchNowNs();
+    InitClusterMatcher(&matcher, local_clusters, local_len, NULL, 0);
+    uint64_t prepare_ns = BenchNowNs() - started;
+
+    started = BenchNowNs();
+    for (uint32_t d = 0; d < DEVICES; ++d) {
+      matcher_matched +=
+          MatcherMatch(remote_clusters[d], REMOTE_CLUSTERS, &matcher);
+    }
+    uint64_t matcher_ns = BenchNowNs() - started;
+
+    // the same remotes matched again, but only MODELS of them distinct
+    uint32_t models_expected = 0;
+    uint32_t models_matched = 0;
+    for (uint32_t d = 0; d < DEVICES; ++d) {
+      models_expected += DistinctMatch(remote_clusters[d % MODELS],
+                                       REMOTE_CLUSTERS, &matcher);
+    }
+    InitMatchResults(&results);
+    started = BenchNowNs();
+    for (uint32_t d = 0; d < DEVICES; ++d) {
+      models_matched += ModelMatch(remote_clusters[d % MODELS],
+                                   REMOTE_CLUSTERS, &matcher, &results,
+                                   supported_mask);
+    }
+    uint64_t models_ns = BenchNowNs() - started;
+
+    if (loop_matched != matcher_matched || models_expected != models_matched) {
+      printf("  results differ: %u vs %u, %u vs %u\n", loop_matched,
+             matcher_matched, models_expected, models_matched);
+    }
+    printf("%6u %12.1f %12.1f %12.0f %12.1f\n", local_len,
+           (double)loop_ns / DEVICES, (double)matcher_ns / DEVICES,
+           (double)prepare_ns, (double)models_ns / DEVICES);
+  }
+
+  HostDeinit();
+}
@@ -0,0 +1,230 @@
+// *******************************************************************
+// * bench-queue.c
+// *
+// * Remotes queue throughput: the former ring buffer (modulo on a
+// * runtime capacity, shared size counter) vs the single-producer/
+// * single-consumer one, in one thread and with the producer and the
+// * consumer in separate threads. Every row includes the recent remotes
+// * index update of AddInDeviceDescriptor, the former ring's rows run
+// * a copy of it
+// *
+// *******************************************************************
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+
+#include "sc-bench.h"
+#include "simple-commissioning-initiator-buffer.h"
+
+/// Remotes passed per row
+#define REMOTES 4000000UL
+/// Remotes kept queued in the one thread rows
+static const QueueIndex_t fills[] = {1, QUEUE_SIZE / 2, QUEUE_SIZE};
+
+/// Ring buffer as the queue had it before, single thread only
+typedef struct ModuloRing {
+  MatchDescriptorReq_t slots[QUEUE_SIZE];
+  uint8_t begin;
+  uint8_t end;
+  uint8_t size;
+  uint8_t capacity;
+  /// Same index as the queue's, updated by RecentAdd()
+  RecentRemotes_t recent;
+} ModuloRing_t;
+
+static ModuloRing_t modulo_ring;
+static MatchDescriptorQueue_t queue;
+/// Keeps the compiler from dropping the consumers' reads
+static volatile uint32_t sink;
+
+/// RecentRemotesAdd() and its helpers of the queue, which are private
+static uint16_t RecentHash(const uint32_t key) {
+  uint32_t hash = key * 2654435761UL;
+
+  return (uint16_t)((hash ^ (hash >> 16)) & RECENT_SLOT_MASK);
+}
+
+static void RecentInit(RecentRemotes_t *recent) {
+  MEMSET(recent->slots, 0xFF, sizeof(recent->slots));
+  recent->oldest = 0;
+  recent->count = 0;
+}
+
+static void RecentRemove(RecentRemotes_t *recent, const uint32_t key) {
+  uint16_t slot = RecentHash(key);
+
+  while (recent->slots[slot] != QUEUE_INDEX_MAX &&
+         recent->keys[recent->slots[slot]] != key) {
+    slot = (slot + 1) & RECENT_SLOT_MASK;
+  }
+  if (recent->slots[slot] == QUEUE_INDEX_MAX) {
+    return;
+  }
+
+  uint16_t next = (slot + 1) & RECENT_SLOT_MASK;
+  while (recent->slots[next] != QUEUE_INDEX_MAX) {
+    uint16_t home = RecentHash(recent->keys[recent->slots[next]]);
+
+    if (((next - home) & RECENT_SLOT_MASK) >=
+        ((next - slot) & RECENT_SLOT_MASK)) {
+      recent->slots[slot] = recent->slots[next];
+      slot = next;
+    }
+    next = (next + 1) & RECENT_SLOT_MASK;
+  }
+  recent->slots[slot] = QUEUE_INDEX_MAX;
+}
+
+static void RecentAdd(RecentRemotes_t *recent, const uint32_t key) {
+  if (recent->count == RECENT_REMOTES) {
+    RecentRemove(recent, recent->keys[recent->oldest]);
+    recent->oldest = (recent->oldest + 1) % RECENT_REMOTES;
+    --recent->count;
+  }
+
+  QueueIndex_t pos = (recent->oldest + recent->count) % RECENT_REMOTES;
+  uint16_t slot = RecentHash(key);
+
+  while (recent->slots[slot] != QUEUE_INDEX_MAX) {
+    slot = (slot + 1) & RECENT_SLOT_MASK;
+  }
+  recent->keys[pos] = key;
+  recent->slots[slot] = pos;
+  ++recent->count;
+}
+
+static bool ModuloRingPush(ModuloRing_t *ring, const EmberNodeId short_id) {
+  if (ring->size == ring->capacity) {
+    return false;
+  }
+
+  MatchDescriptorReq_t *slot = &ring->slots[ring->end];
+  slot->source = short_id;
+  slot->source_ep = 1;
+  slot->stage = SC_REMOTE_QUEUED;
+  slot->lookups = 0;
+  slot->reporting_pending = 0;
+  slot->clusters.count = 0;
+  slot->sm.transition.next_state = SC_EZ_DISCOVER;
+  slot->sm.transition.next_event = SC_EZEV_CHECK_CLUSTERS;
+  slot->sm.time_to_execute = 0;
+  slot->sm.scheduled = false;
+  ++ring->size;
+  ring->end = (ring->end + 1) % ring->capacity;
+  RecentAdd(&ring->recent, ((uint32_t)short_id << 8) | slot->source_ep);
+
+  return true;
+}
+
+static MatchDescriptorReq_t *ModuloRingTop(ModuloRing_t *ring) {
+  return ring->size ? &ring->slots[ring->begin] : NULL;
+}
+
+static void ModuloRingPop(ModuloRing_t *ring) {
+  --ring->size;
+  ring->begin = (ring->begin + 1) % ring->capacity;
+}
+
+static double ModuloRingNsPerRemote(const QueueIndex_t fill) {
+  uint32_t sum = 0;
+
+  modulo_ring.begin = modulo_ring.end = modulo_ring.size = 0;
+  modulo_ring.capacity = QUEUE_SIZE;
+  RecentInit(&modulo_ring.recent);
+  for (QueueIndex_t i = 1; i < fill; ++i) {
+    ModuloRingPush(&modulo_ring, 0);
+  }
+
+  uint64_t started = BenchNowNs();
+  for (uint32_t i = 0; i < REMOTES; ++i) {
+    ModuloRingPush(&modulo_ring, (EmberNodeId)i);
+    sum += ModuloRingTop(&modulo_ring)->source;
+    ModuloRingPop(&modulo_ring);
+  }
+  uint64_t elapsed = BenchNowNs() - started;
+
+  sink = sum;
+  return (double)elapsed / REMOTES;
+}
+
+static double QueueNsPerRemote(const QueueIndex_t fill) {
+  uint32_t sum = 0;
+
+  InitQueue(&queue);
+  for (QueueIndex_t i = 1; i < fill; ++i) {
+    AddInDeviceDescriptor(&queue, 0, 1);
+  }
+
+  uint64_t started = BenchNowNs();
+  for (uint32_t i = 0; i < REMOTES; ++i) {
+    AddInDeviceDescriptor(&queue, (EmberNodeId)i, 1);
+    sum += GetTopInDeviceDescriptor(&queue)->source;
+    PopInDeviceDescriptor(&queue);
+  }
+  uint64_t elapsed = BenchNowNs() - started;
+
+  sink = sum;
+  return (double)elapsed / REMOTES;
+}
+
+static void *QueueProducer(void *arg) {
+  for (uint32_t i = 0; i < REMOTES;) {
+    if (AddInDeviceDescriptor(&queue, (EmberNodeId)i, 1)) {
+      ++i;
+    } else {
+      sched_yield();
+    }
+  }
+
+  return arg;
+}
+
+static double QueueThreadsNsPerRemote(void) {
+  pthread_t producer;
+  uint32_t sum = 0;
+
+  InitQueue(&queue);
+
+  uint64_t started = BenchNowNs();
+  if (pthread_create(&producer, NULL, QueueProducer, NULL) != 0) {
+    return 0.0;
+  }
+  for (uint32_t i = 0; i < REMOTES;) {
+    MatchDescriptorReq_t *top = GetTopInDeviceDescriptor(&queue);
+
+    if (top == NULL) {
+      sched_yield();
+      continue;
+    }
+    sum += top->source;
+    PopInDeviceDescriptor(&queue);
+    ++i;
+  }
+  pthread_join(producer, NULL);
+  uint64_t elapsed = BenchNowNs() - started;
+
+  sink = sum;
+  return (double)elapsed / REMOTES;
+}
+
+void BenchRemotesQueue(void) {
+  printf("%lu remotes per row, queue of %u (%u slots)\n", REMOTES,
+         QUEUE_SIZE, QUEUE_SLOTS);
+  printf("%-8s %6s %10s %14s\n", "threads", "fill", "ns/remote",
+         "remotes/s");
+
+  for (size_t i = 0; i < COUNTOF(fills); ++i) {
+    double modulo_ns = ModuloRingNsPerRemote(fills[i]);
+    double queue_ns = QueueNsPerRemote(fills[i]);
+
+    printf("%-8s %6u %10.2f %14.0f  modulo ring\n", "1", fills[i], modulo_ns,
+           1e9 / modulo_ns);
+    printf("%-8s %6u %10.2f %14.0f  spsc queue\n", "1", fills[i], queue_ns,
+           1e9 / queue_ns);
+  }
+
+  double threads_ns = QueueThreadsNsPerRemote();
+  printf("%-8s %6s %10.2f %14.0f  spsc queue\n", "2", "-",
+         threads_ns, threads_ns > 0 ? 1e9 / threads_ns : 0.0);
+}
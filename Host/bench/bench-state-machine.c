@@ -0,0 +1,90 @@
+// *******************************************************************
+// * bench-state-machine.c
+// *
+// * Cost of the plugin's event handler per wake-up: transition lookup,
+// * handlers and rescheduling, measured over whole sessions against
+// * virtual lights. Network deliveries are not counted
+// *
+// *******************************************************************
+
+#include <stdio.h>
+
+#include "ember-host.h"
+#include "sc-bench.h"
+#include "simple-commissioning-initiator-internal.h"
+#include "simple-commissioning-initiator.h"
+
+#define LOCAL_EP 1
+#define REMOTE_EP 10
+/// Sessions run per number of lights
+#define SESSIONS 256
+#define RUN_LIMIT_MS (10 * 60 * 1000UL)
+
+static const uint16_t light_counts[] = {1, 8, 32};
+static const uint16_t light_in[] = {0x0000, 0x0003, 0x0004,
+                                    0x0005, 0x0006, 0x0008};
+static const uint16_t local_clusters[] = {0x0006, 0x0008};
+
+static void AddLights(uint16_t count) {
+  for (uint16_t i = 0; i < count; ++i) {
+    HostNode_t node = {.node_id = (EmberNodeId)(0x1000 + i),
+                       .endpoint = REMOTE_EP,
+                       .in_clusters = light_in,
+                       .in_count = COUNTOF(light_in),
+                       .identify_time = 60,
+                       .rtt_ms = 30,
+                       .jitter_ms = 20};
+
+    for (uint8_t b = 0; b < EUI64_SIZE; ++b) {
+      node.eui64[b] = (uint8_t)(node.node_id >> ((b & 1) * 8)) ^ b;
+    }
+    HostAddNode(&node);
+  }
+}
+
+void BenchStateMachine(void) {
+  printf("%u sessions per row, cost per event handler run\n", SESSIONS);
+  printf("%6s %14s %12s %14s\n", "lights", "runs/session", "ns/run",
+         "ns/session");
+
+  for (size_t i = 0; i < COUNTOF(light_counts); ++i) {
+    uint64_t handler_ns = 0;
+    uint32_t runs = 0;
+
+    HostInit(NULL);
+    AddLights(light_counts[i]);
+
+    for (uint32_t session = 0; session < SESSIONS; ++session) {
+      // every session binds all lights again
+      emberClearBindingTable();
+      if (SimpleCommissioningStart(LOCAL_EP, false, local_clusters,
+                                   COUNTOF(local_clusters)) != EMBER_SUCCESS) {
+        printf("  start failed\n");
+        break;
+      }
+
+      uint32_t deadline = halCommonGetInt32uMillisecondTick() + RUN_LIMIT_MS;
+      while (CommissioningStateMachineStatus() != SC_EZ_STOP ||
+             emberEventControlGetActive(StateMachineEvent)) {
+        uint32_t events_run = HostGetStats()->events_run;
+        uint64_t started = BenchNowNs();
+
+        if (!HostStep() || halCommonGetInt32uMillisecondTick() > deadline) {
+          break;
+        }
+
+        uint64_t elapsed = BenchNowNs() - started;
+        if (HostGetStats()->events_run != events_run) {
+          handler_ns += elapsed;
+          ++runs;
+        }
+      }
+    }
+
+    printf("%6u %14.1f %12.0f %14.0f\n", light_counts[i],
+           (double)runs / SESSIONS, runs ? (double)handler_ns / runs : 0.0,
+           (double)handler_ns / SESSIONS);
+  }
+
+  HostDeinit();
+}
@@ -0,0 +1,58 @@
+// *******************************************************************
+// * sc-bench.c
+// *
+// * Runs all benchmarks or the ones named on the command line
+// *
+// *******************************************************************
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "sc-bench.h"
+
+static const struct {
+  const char *name;
+  void (*run)(void);
+} benchmarks[] = {
+    {"binding-duplicates", BenchBindingDuplicates},
+    {"cluster-matching", BenchClusterMatching},
+    {"remotes-queue", BenchRemotesQueue},
+    {"state-machine", BenchStateMachine},
+};
+
+uint64_t BenchNowNs(void) {
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+
+  return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+int main(int argc, char **argv) {
+  int run = 0;
+
+  for (size_t i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); ++i) {
+    bool selected = (argc < 2);
+
+    for (int arg = 1; arg < argc && !selected; ++arg) {
+      selected = (strcmp(argv[arg], benchmarks[i].name) == 0);
+    }
+    if (selected) {
+      printf("== %s\n", benchmarks[i].name);
+      benchmarks[i].run();
+      ++run;
+    }
+  }
+
+  if (run == 0) {
+    printf("usage: %s [benchmark...]\n", argv[0]);
+    for (size_t i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); ++i) {
+      printf("  %s\n", benchmarks[i].name);
+    }
+    return 2;
+  }
+
+  return 0;
+}
@@ -0,0 +1,29 @@
+// *******************************************************************
+// * sc-bench.h
+// *
+// * Micro benchmarks of the Simple Commissioning Initiator's building
+// * blocks running against the host-side EmberZNet stand-in
+// *
+// *******************************************************************
+
+#ifndef SC_BENCH_H
+#define SC_BENCH_H
+
+#include <stdint.h>
+
+/// Monotonic wall clock (in nanoseconds)
+uint64_t BenchNowNs(void);
+
+/// Benchmarks, every one prints its own results table
+/// Binding table duplicate check: table scan vs RAM mirror
+void BenchBindingDuplicates(void);
+/// Remote clusters matching: nested loop vs local clusters set vs
+/// match results reuse
+void BenchClusterMatching(void);
+/// Remotes queue: former ring buffer vs single-producer/single-consumer
+/// one, in one and two threads
+void BenchRemotesQueue(void);
+/// Commissioning state machine: event handler cost per wake-up
+void BenchStateMachine(void);
+
+#endif  // SC_BENCH_H
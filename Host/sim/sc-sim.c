@@ -0,0 +1,370 @@
+// *******************************************************************
+// * sc-sim.c
+// *
+// * Discrete-event benchmark of the Simple Commissioning Initiator.
+// * Models N virtual remotes answering the Identify Query broadcast
+// * and ZDO discovery requests and runs commissioning rounds until
+// * every matching remote is bound or a round binds nothing new.
+// *
+// *******************************************************************
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ember-host.h"
+#include "simple-commissioning-initiator-internal.h"
+#include "simple-commissioning-initiator.h"
+
+#define LOCAL_EP 1
+#define REMOTE_EP 1
+#define FIRST_NODE_ID 0x0100
+/// Give a session this much virtual time before it is declared stuck
+#define SESSION_LIMIT_MS (60 * 60 * 1000UL)
+/// Stop after this much consecutive rounds binding nothing new
+#define IDLE_ROUNDS_LIMIT 10
+
+/*! \typedef struct SimOptions
+    \brief Simulation parameters taken from the command line
+*/
+typedef struct SimOptions {
+  uint32_t nodes;
+  uint32_t rtt_ms;
+  uint32_t jitter_ms;
+  uint8_t loss_pct;
+  uint8_t duplicate_pct;
+  uint8_t matching_pct;
+  uint8_t sleepy_pct;
+  uint8_t known_pct;
+  uint32_t poll_ms;
+  uint16_t binding_table_size;
+  uint8_t discovery_states;
+  uint32_t rounds;
+  uint32_t seed;
+  uint16_t expected;
+  bool recommission;
+  bool verbose;
+} SimOptions_t;
+
+/// Local client clusters to commission
+static const uint16_t local_clusters[] = {0x0006, 0x0008};
+/// Light: matches local clusters
+static const uint16_t light_in[] = {0x0000, 0x0003, 0x0004,
+                                    0x0005, 0x0006, 0x0008};
+/// Temperature sensor: answers Identify Query but does not match
+static const uint16_t sensor_in[] = {0x0000, 0x0001, 0x0003, 0x0402};
+static const uint16_t sensor_out[] = {0x0019};
+
+static bool *node_bound;
+
+static void Usage(const char *name) {
+  printf(
+      "usage: %s [options]\n"
+      "  -n <nodes>     virtual remotes answering Identify Query (100)\n"
+      "  -r <ms>        round trip time (30)\n"
+      "  -j <ms>        round trip jitter upper bound (20)\n"
+      "  -l <pct>       frame loss probability (0)\n"
+      "  -D <pct>       duplicated Identify Query responses (0)\n"
+      "  -m <pct>       remotes matching the local clusters (100)\n"
+      "  -s <pct>       sleepy end devices (0)\n"
+      "  -p <ms>        sleepy poll period (1000)\n"
+      "  -k <pct>       remotes known from the local stack tables (0)\n"
+      "  -b <entries>   binding table size (2 * nodes * clusters, up to %u)\n"
+      "  -d <states>    concurrent service discoveries (4)\n"
+      "  -R <rounds>    maximal commissioning rounds (1000)\n"
+      "  -S <seed>      pseudo random seed (1)\n"
+      "  -e <remotes>   remotes expected to answer Identify Query (unknown)\n"
+      "  -A             clear the binding table and commission again\n"
+      "  -v             print plugin's debug output\n",
+      name, EMBER_BINDING_TABLE_SIZE);
+}
+
+static bool ParseOptions(int argc, char **argv, SimOptions_t *opts) {
+  int opt;
+
+  *opts = (SimOptions_t){.nodes = 100,
+                         .rtt_ms = 30,
+                         .jitter_ms = 20,
+                         .matching_pct = 100,
+                         .poll_ms = 1000,
+                         .discovery_states = 4,
+                         .rounds = 1000,
+                         .seed = 1};
+
+  while ((opt = getopt(argc, argv, "n:r:j:l:D:m:s:p:k:b:d:R:S:e:Avh")) != -1) {
+    unsigned long value = (optarg != NULL) ? strtoul(optarg, NULL, 0) : 0;
+
+    switch (opt) {
+      case 'n':
+        opts->nodes = (uint32_t)value;
+        break;
+      case 'r':
+        opts->rtt_ms = (uint32_t)value;
+        break;
+      case 'j':
+        opts->jitter_ms = (uint32_t)value;
+        break;
+      case 'l':
+        opts->loss_pct = (uint8_t)(value > 100 ? 100 : value);
+        break;
+      case 'D':
+        opts->duplicate_pct = (uint8_t)(value > 100 ? 100 : value);
+        break;
+      case 'm':
+        opts->matching_pct = (uint8_t)(value > 100 ? 100 : value);
+        break;
+      case 's':
+        opts->sleepy_pct = (uint8_t)(value > 100 ? 100 : value);
+        break;
+      case 'p':
+        opts->poll_ms = (uint32_t)value;
+        break;
+      case 'k':
+        opts->known_pct = (uint8_t)(value > 100 ? 100 : value);
+        break;
+      case 'b':
+        opts->binding_table_size = (uint16_t)value;
+        break;
+      case 'd':
+        opts->discovery_states = (uint8_t)value;
+        break;
+      case 'R':
+        opts->rounds = (uint32_t)value;
+        break;
+      case 'S':
+        opts->seed = (uint32_t)value;
+        break;
+      case 'e':
+        opts->expected = (uint16_t)value;
+        break;
+      case 'A':
+        opts->recommission = true;
+        break;
+      case 'v':
+        opts->verbose = true;
+        break;
+      default:
+        return false;
+    }
+  }
+
+  if (opts->nodes == 0 || opts->nodes > 0xFF00 - FIRST_NODE_ID) {
+    printf("number of nodes must be in range 1..%u\n",
+           0xFF00 - FIRST_NODE_ID);
+    return false;
+  }
+
+  if (opts->binding_table_size == 0) {
+    uint32_t size = 2 * opts->nodes * COUNTOF(local_clusters);
+    opts->binding_table_size = (uint16_t)(
+        size > EMBER_BINDING_TABLE_SIZE ? EMBER_BINDING_TABLE_SIZE : size);
+  }
+
+  return true;
+}
+
+/// Node's EUI64 keeps its index for mapping bindings back to nodes
+static void MakeEui64(uint32_t index, EmberEUI64 eui64) {
+  static const uint8_t oui[] = {0x00, 0x0D, 0x6F, 0x00};
+
+  for (uint8_t i = 0; i < 4; ++i) {
+    eui64[i] = (uint8_t)(index >> (8 * i));
+    eui64[4 + i] = oui[3 - i];
+  }
+}
+
+static uint32_t Eui64ToIndex(const EmberEUI64 eui64) {
+  return (uint32_t)eui64[0] | ((uint32_t)eui64[1] << 8) |
+         ((uint32_t)eui64[2] << 16) | ((uint32_t)eui64[3] << 24);
+}
+
+static void CreateNodes(const SimOptions_t *opts, uint32_t *matching,
+                        uint32_t *sleepy) {
+  *matching = 0;
+  *sleepy = 0;
+
+  for (uint32_t i = 0; i < opts->nodes; ++i) {
+    bool is_light = (HostRandom() % 100) < opts->matching_pct;
+    bool is_sleepy = (HostRandom() % 100) < opts->sleepy_pct;
+    bool is_known = opts->known_pct != 0 &&
+                    (HostRandom() % 100) < opts->known_pct;
+    HostNode_t node = {.node_id = (EmberNodeId)(FIRST_NODE_ID + i),
+                       .endpoint = REMOTE_EP,
+                       .in_stack_tables = is_known,
+                       .identify_time = 180,
+                       .rtt_ms = opts->rtt_ms,
+                       .jitter_ms = opts->jitter_ms,
+                       .loss_pct = opts->loss_pct,
+                       .duplicate_pct = opts->duplicate_pct,
+                       .poll_ms = is_sleepy ? opts->poll_ms : 0};
+
+    if (is_light) {
+      node.in_clusters = light_in;
+      node.in_count = COUNTOF(light_in);
+    } else {
+      node.in_clusters = sensor_in;
+      node.in_count = COUNTOF(sensor_in);
+      node.out_clusters = sensor_out;
+      node.out_count = COUNTOF(sensor_out);
+    }
+
+    MakeEui64(i, node.eui64);
+    HostAddNode(&node);
+    *matching += is_light ? 1 : 0;
+    *sleepy += is_sleepy ? 1 : 0;
+  }
+}
+
+/// Mark nodes having at least one binding, returns number of bound nodes
+static uint32_t CollectBoundNodes(const SimOptions_t *opts) {
+  EmberBindingTableEntry entry;
+  uint32_t bound = 0;
+
+  for (uint16_t i = 0; i < emberBindingTableSize; ++i) {
+    if (emberGetBinding(i, &entry) != EMBER_SUCCESS ||
+        entry.type == EMBER_UNUSED_BINDING) {
+      continue;
+    }
+
+    uint32_t index = Eui64ToIndex(entry.identifier);
+    if (index < opts->nodes && !node_bound[index]) {
+      node_bound[index] = true;
+      ++bound;
+    }
+  }
+
+  return bound;
+}
+
+/// Run commissioning rounds until every matching node is bound, returns
+/// the number of bound nodes
+static uint32_t RunRounds(const SimOptions_t *opts, uint32_t matching,
+                          uint32_t *round) {
+  uint32_t bound = 0;
+  uint32_t idle_rounds = 0;
+
+  *round = 0;
+  while (*round < opts->rounds && bound < matching &&
+         idle_rounds < IDLE_ROUNDS_LIMIT) {
+    uint32_t started = HostNow();
+    EmberStatus status = SimpleCommissioningStart(
+        LOCAL_EP, false, local_clusters, COUNTOF(local_clusters));
+
+    if (status != EMBER_SUCCESS) {
+      printf("round %u: start failed 0x%02X\n", *round + 1, status);
+      break;
+    }
+
+    HostRunUntilIdle(started + SESSION_LIMIT_MS);
+    ++*round;
+
+    uint32_t new_bound = CollectBoundNodes(opts);
+    bound += new_bound;
+    idle_rounds = (new_bound == 0) ? idle_rounds + 1 : 0;
+    if (opts->verbose) {
+      printf("round %u: %.3f s, bound %u/%u (+%u)\n", *round,
+             (HostNow() - started) / 1000.0, bound, matching, new_bound);
+    }
+  }
+
+  return bound;
+}
+
+int main(int argc, char **argv) {
+  SimOptions_t opts;
+  HostConfig_t config;
+  uint32_t matching = 0;
+  uint32_t sleepy = 0;
+  uint32_t bound = 0;
+  uint32_t round = 0;
+
+  if (!ParseOptions(argc, argv, &opts)) {
+    Usage(argv[0]);
+    return 2;
+  }
+
+  HostDefaultConfig(&config);
+  config.binding_table_size = opts.binding_table_size;
+  config.discovery_states = opts.discovery_states;
+  config.seed = opts.seed;
+  config.verbose = opts.verbose;
+  HostInit(&config);
+
+  node_bound = calloc(opts.nodes, sizeof(*node_bound));
+  assert(node_bound != NULL);
+  CreateNodes(&opts, &matching, &sleepy);
+
+  printf("nodes %u (matching %u, sleepy %u), rtt %u+%u ms, loss %u%%\n",
+         opts.nodes, matching, sleepy, opts.rtt_ms, opts.jitter_ms,
+         opts.loss_pct);
+  printf("remotes queue %u, binding table %u, discovery states %u\n",
+         EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_REMOTES_QUEUE,
+         opts.binding_table_size, opts.discovery_states);
+
+  uint32_t started = HostNow();
+  SimpleCommissioningSetExpectedRemotes(opts.expected);
+  bound = RunRounds(&opts, matching, &round);
+  double sessions_s = (HostNow() - started) / 1000.0;
+
+  const HostStats_t *stats = HostGetStats();
+  double last_binding_s = stats->last_binding_ms / 1000.0;
+  uint32_t discovered = stats->zdo_simple_descriptor_requests;
+  uint32_t dropped = (stats->identify_responses > discovered)
+                         ? stats->identify_responses - discovered
+                         : 0;
+
+  printf("rounds                  : %u\n", round);
+  printf("devices bound           : %u/%u\n", bound, matching);
+  printf("bindings created        : %u\n", stats->bindings_created);
+  printf("time to last binding    : %.3f s\n", last_binding_s);
+  printf("time in sessions        : %.3f s\n", sessions_s);
+  printf("throughput              : %.1f devices/min\n",
+         last_binding_s > 0 ? bound * 60.0 / last_binding_s : 0.0);
+  printf("identify responses      : %u\n", stats->identify_responses);
+  printf("dropped responses       : %u\n", dropped);
+  printf("frames sent             : %u\n", stats->frames_sent);
+  printf("  broadcasts            : %u\n", stats->broadcasts);
+  printf("  simple descriptor req : %u\n",
+         stats->zdo_simple_descriptor_requests);
+  printf("  ieee address req      : %u\n", stats->zdo_ieee_requests);
+  printf("eui64 known locally     : %u (asked %u)\n",
+         SimpleCommissioningGetStats()->eui64_local_hits,
+         SimpleCommissioningGetStats()->eui64_local_misses);
+  const SimpleCommissioningRttEstimator_t *rtt =
+      SimpleCommissioningGetRttEstimator(0);
+  printf("rtt estimate            : %.1f ms (+-%.1f ms, %u samples)\n",
+         rtt->srtt / 8.0, rtt->rttvar / 4.0, rtt->samples);
+  printf("response wait window    : %u ms\n",
+         SimpleCommissioningGetResponseWaitTime(0));
+  printf("zdo timeouts            : %u\n", stats->zdo_timeouts);
+  printf("zdo rejected            : %u\n", stats->zdo_rejected);
+  printf("frames lost on air      : %u\n", stats->frames_lost);
+  printf("event handler runs      : %u\n", stats->events_run);
+
+  if (opts.recommission) {
+    uint32_t zdo_requests = stats->zdo_requests;
+    started = HostNow();
+
+    emberClearBindingTable();
+    MEMSET(node_bound, 0, opts.nodes * sizeof(*node_bound));
+    SimpleCommissioningClearStats();
+    bound = RunRounds(&opts, matching, &round);
+
+    printf("re-commissioning\n");
+    printf("  rounds                : %u\n", round);
+    printf("  devices bound         : %u/%u\n", bound, matching);
+    printf("  time to last binding  : %.3f s\n",
+           (stats->last_binding_ms - started) / 1000.0);
+    printf("  zdo requests          : %u\n",
+           stats->zdo_requests - zdo_requests);
+    printf("  cached descriptors    : %u (missed %u, stale %u)\n",
+           SimpleCommissioningGetStats()->descriptor_cache_hits,
+           SimpleCommissioningGetStats()->descriptor_cache_misses,
+           SimpleCommissioningGetStats()->descriptor_cache_stale);
+  }
+
+  free(node_bound);
+  HostDeinit();
+
+  return 0;
+}
@@ -0,0 +1,17 @@
+// *******************************************************************
+// * af-gen-event.c
+// *
+// * Host counterpart of the AppBuilder generated events table
+// *
+// *******************************************************************
+
+#include "app/framework/include/af.h"
+
+extern EmberEventControl
+    emberAfPluginSimpleCommissioningInitiatorStateMachineEventControl;
+void emberAfPluginSimpleCommissioningInitiatorStateMachineEventHandler(void);
+
+EmberEventData emAfEvents[] = {
+    {&emberAfPluginSimpleCommissioningInitiatorStateMachineEventControl,
+     emberAfPluginSimpleCommissioningInitiatorStateMachineEventHandler},
+    {NULL, NULL}};
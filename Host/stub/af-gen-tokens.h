@@ -0,0 +1,26 @@
+// *******************************************************************
+// * af-gen-tokens.h
+// *
+// * Host counterpart of the AppBuilder generated tokens header: token
+// * types and TOKEN_<name> IDs of the plugins' token headers
+// *
+// *******************************************************************
+
+#ifndef AF_GEN_TOKENS_H
+#define AF_GEN_TOKENS_H
+
+#define DEFINETYPES
+#include "simple-commissioning-initiator-tokens.h"
+#undef DEFINETYPES
+
+/// Token IDs, TOKEN_COUNT is the number of tokens
+#define DEFINE_INDEXED_TOKEN(name, type, arraysize, ...) TOKEN_##name,
+enum {
+#define DEFINETOKENS
+#include "simple-commissioning-initiator-tokens.h"
+#undef DEFINETOKENS
+  TOKEN_COUNT
+};
+#undef DEFINE_INDEXED_TOKEN
+
+#endif  // AF_GEN_TOKENS_H
@@ -0,0 +1,391 @@
+// *******************************************************************
+// * af.h
+// *
+// * Host-side stand-in for the EmberZNet Application Framework header.
+// * Provides just enough of the stack API for the commissioning plugin
+// * to compile and run on a workstation against a virtual clock and a
+// * simulated network (see ember-host.h).
+// *
+// *******************************************************************
+
+#ifndef SILABS_AF_API_HOST_STUB
+#define SILABS_AF_API_HOST_STUB
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/*! Plugin options normally generated by AppBuilder into the app header.
+    Might be overridden from the build system.
+*/
+#ifndef EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_REMOTES_QUEUE
+#define EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_REMOTES_QUEUE 8
+#endif
+#ifndef EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_COMMISSIONING_CLUSTERS_LIST_LEN
+#define EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_COMMISSIONING_CLUSTERS_LIST_LEN \
+  16
+#endif
+#ifndef EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_LOCAL_CLUSTERS_LIST_LEN
+#define EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_LOCAL_CLUSTERS_LIST_LEN 16
+#endif
+#ifndef EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_DISCOVERY_WINDOW
+#define EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_DISCOVERY_WINDOW 1
+#endif
+#ifndef EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_MATCH_RESULTS_CACHE
+#define EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_MATCH_RESULTS_CACHE 4
+#endif
+#ifndef EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_DESCRIPTOR_CACHE
+#define EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_DESCRIPTOR_CACHE 0
+#endif
+#ifndef EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_IDENTIFY_QUIET_PERIOD
+#define EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_IDENTIFY_QUIET_PERIOD 0
+#endif
+#ifndef EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_IDENTIFY_WINDOW_LIMIT
+#define EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_IDENTIFY_WINDOW_LIMIT \
+  3000
+#endif
+#ifndef EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_RUN_STEPS_BUDGET
+#define EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_RUN_STEPS_BUDGET 16
+#endif
+#ifndef EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_RUN_TIME_BUDGET
+#define EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_RUN_TIME_BUDGET 5
+#endif
+#ifndef EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_SESSIONS
+#define EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_SESSIONS 1
+#endif
+#ifndef EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_SESSION_ENDPOINTS
+#define EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_SESSION_ENDPOINTS 1
+#endif
+#ifndef EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_REPORTING_WINDOW
+#define EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_REPORTING_WINDOW 4
+#endif
+
+/// Legacy Ember integer types
+typedef bool boolean;
+typedef uint8_t int8u;
+typedef int8_t int8s;
+typedef uint16_t int16u;
+typedef int16_t int16s;
+typedef uint32_t int32u;
+typedef int32_t int32s;
+
+#ifndef TRUE
+#define TRUE true
+#endif
+#ifndef FALSE
+#define FALSE false
+#endif
+
+/// Utility macros from hal/micro/generic
+#define MEMCOPY(d, s, n) memmove((d), (s), (n))
+#define MEMSET(d, v, n) memset((d), (v), (n))
+#define MEMCOMPARE(a, b, n) memcmp((a), (b), (n))
+#define HIGH_BYTE(n) ((uint8_t)(((n) >> 8) & 0xFF))
+#define LOW_BYTE(n) ((uint8_t)((n)&0xFF))
+#define BIT(x) (1U << (x))
+#define COUNTOF(a) (sizeof(a) / sizeof(a[0]))
+
+/// As on the target, test asserts compile to nothing unless EMBER_TEST is set
+#ifdef EMBER_TEST
+#define EMBER_TEST_ASSERT(x) assert(x)
+#else
+#define EMBER_TEST_ASSERT(x)
+#endif
+
+/// Basic stack types
+typedef uint8_t EmberStatus;
+typedef uint16_t EmberNodeId;
+typedef uint16_t EmberPanId;
+#define EUI64_SIZE 8
+typedef uint8_t EmberEUI64[EUI64_SIZE];
+
+/// Subset of the EmberStatus codes
+enum {
+  EMBER_SUCCESS = 0x00,
+  EMBER_ERR_FATAL = 0x01,
+  EMBER_BAD_ARGUMENT = 0x02,
+  EMBER_NO_BUFFERS = 0x18,
+  EMBER_INVALID_CALL = 0x70,
+  EMBER_INVALID_BINDING_INDEX = 0x75,
+  EMBER_NOT_FOUND = 0x77,
+  EMBER_NETWORK_BUSY = 0xA1,
+  EMBER_APPLICATION_ERROR_0 = 0xF0,
+  EMBER_APPLICATION_ERROR_1 = 0xF1
+};
+
+#define EMBER_NULL_NODE_ID 0xFFFF
+#define EMBER_BROADCAST_ENDPOINT 0xFF
+#define EMBER_SLEEPY_BROADCAST_ADDRESS 0xFFFF
+#define EMBER_RX_ON_WHEN_IDLE_BROADCAST_ADDRESS 0xFFFD
+#define EMBER_ZCL_STATUS_SUCCESS 0x00
+
+typedef enum {
+  EMBER_NO_NETWORK,
+  EMBER_JOINING_NETWORK,
+  EMBER_JOINED_NETWORK,
+  EMBER_JOINED_NETWORK_NO_PARENT,
+  EMBER_LEAVING_NETWORK
+} EmberNetworkStatus;
+
+typedef enum {
+  EMBER_UNKNOWN_DEVICE = 0,
+  EMBER_COORDINATOR = 1,
+  EMBER_ROUTER = 2,
+  EMBER_END_DEVICE = 3,
+  EMBER_SLEEPY_END_DEVICE = 4
+} EmberNodeType;
+
+/// Event controls
+typedef enum {
+  EMBER_EVENT_INACTIVE = 0,
+  EMBER_EVENT_MS_TIME,
+  EMBER_EVENT_QS_TIME,
+  EMBER_EVENT_ZERO_DELAY
+} EmberEventUnits;
+
+typedef struct {
+  EmberEventUnits status;
+  uint32_t timeToExecute;
+} EmberEventControl;
+
+typedef struct EmberEventData_S {
+  EmberEventControl *control;
+  void (*handler)(void);
+} EmberEventData;
+
+void emEventControlSetActive(EmberEventControl *event);
+void emEventControlSetDelay(EmberEventControl *event, uint32_t delay_ms,
+                            EmberEventUnits units);
+
+#define emberEventControlSetInactive(control) \
+  do {                                        \
+    (control).status = EMBER_EVENT_INACTIVE;  \
+  } while (0)
+#define emberEventControlSetActive(control) emEventControlSetActive(&(control))
+#define emberEventControlSetDelayMS(control, delay) \
+  emEventControlSetDelay(&(control), (delay), EMBER_EVENT_MS_TIME)
+#define emberEventControlSetDelayQS(control, delay) \
+  emEventControlSetDelay(&(control), (uint32_t)(delay)*250, EMBER_EVENT_QS_TIME)
+#define emberEventControlGetActive(control) \
+  ((control).status != EMBER_EVENT_INACTIVE)
+
+/// Virtual millisecond tick
+uint32_t halCommonGetInt32uMillisecondTick(void);
+
+/// Tokens, kept in host memory until HostInit()
+#include "af-gen-tokens.h"
+
+void halCommonGetIndexedToken(void *data, uint16_t token, uint8_t index);
+void halCommonSetIndexedToken(uint16_t token, uint8_t index, void *data);
+
+/// Binding table
+#define EMBER_UNUSED_BINDING 0
+#define EMBER_UNICAST_BINDING 1
+#define EMBER_MANY_TO_ONE_BINDING 2
+#define EMBER_MULTICAST_BINDING 3
+
+typedef uint8_t EmberBindingType;
+
+typedef struct {
+  EmberBindingType type;
+  uint8_t local;
+  uint16_t clusterId;
+  uint8_t remote;
+  EmberEUI64 identifier;
+  uint8_t networkIndex;
+} EmberBindingTableEntry;
+
+/// Binding table size the application is built with. On the host the table
+/// size is a run time value up to it and may exceed 255 entries
+#ifndef EMBER_BINDING_TABLE_SIZE
+#define EMBER_BINDING_TABLE_SIZE 16384
+#endif
+extern uint16_t emberBindingTableSize;
+
+EmberStatus emberGetBinding(uint16_t index, EmberBindingTableEntry *result);
+EmberStatus emberSetBinding(uint16_t index, EmberBindingTableEntry *value);
+EmberStatus emberDeleteBinding(uint16_t index);
+EmberStatus emberClearBindingTable(void);
+void emberSetBindingRemoteNodeId(uint16_t index, EmberNodeId id);
+EmberNodeId emberGetBindingRemoteNodeId(uint16_t index);
+/// Stack callbacks implemented by the application, called after a remote
+/// node's ZDO Bind or Unbind request has changed the binding table. The
+/// host's report the changes to the plugin
+void emberRemoteSetBindingHandler(EmberBindingTableEntry *entry);
+void emberRemoteDeleteBindingHandler(uint8_t index);
+
+/// ZCL command context
+typedef struct {
+  uint16_t profileId;
+  uint16_t clusterId;
+  uint8_t sourceEndpoint;
+  uint8_t destinationEndpoint;
+  uint16_t options;
+  uint16_t groupId;
+  uint8_t sequence;
+} EmberApsFrame;
+
+typedef struct {
+  EmberApsFrame *apsFrame;
+  uint8_t type;
+  EmberNodeId source;
+  uint8_t *buffer;
+  uint16_t bufLen;
+  bool clusterSpecific;
+  bool mfgSpecific;
+  uint16_t mfgCode;
+  uint8_t seqNum;
+  uint8_t commandId;
+  uint8_t payloadStartIndex;
+  uint8_t direction;
+  uint8_t networkIndex;
+} EmberAfClusterCommand;
+
+typedef uint16_t EmberAfClusterId;
+typedef uint16_t EmberAfAttributeId;
+
+typedef enum {
+  EMBER_OUTGOING_DIRECT,
+  EMBER_OUTGOING_VIA_ADDRESS_TABLE,
+  EMBER_OUTGOING_VIA_BINDING
+} EmberOutgoingMessageType;
+
+/// Global commands and attribute reporting
+#define ZCL_CONFIGURE_REPORTING_COMMAND_ID 0x06
+#define ZCL_CONFIGURE_REPORTING_RESPONSE_COMMAND_ID 0x07
+#define EMBER_ZCL_REPORTING_DIRECTION_REPORTED 0x00
+
+/// Largest APS payload and the ZCL header taking a part of it
+#define EMBER_AF_MAXIMUM_SEND_PAYLOAD_LENGTH 82
+#define EMBER_AF_ZCL_OVERHEAD 3
+
+/// Kinds of ZCL data types returned by
+/// emberAfGetAttributeAnalogOrDiscreteType()
+#define EMBER_AF_DATA_TYPE_ANALOG 0
+#define EMBER_AF_DATA_TYPE_DISCRETE 1
+#define EMBER_AF_DATA_TYPE_NONE 2
+
+const EmberAfClusterCommand *emberAfCurrentCommand(void);
+EmberStatus emberAfSendImmediateDefaultResponse(uint8_t status);
+void emberAfFillCommandIdentifyClusterIdentifyQuery(void);
+void emberAfFillCommandGlobalClientToServerConfigureReporting(
+    EmberAfClusterId clusterId, uint8_t *attributes,
+    uint16_t attributesLength);
+void emberAfSetCommandEndpoints(uint8_t source_endpoint,
+                                uint8_t destination_endpoint);
+EmberStatus emberAfSendCommandBroadcast(EmberNodeId destination);
+EmberStatus emberAfSendCommandUnicast(EmberOutgoingMessageType type,
+                                      uint16_t indexOrDestination);
+/// Size of a value of the ZCL @dataType (in bytes), 0 if it is not fixed
+uint8_t emberAfGetDataSize(uint8_t dataType);
+uint8_t emberAfGetAttributeAnalogOrDiscreteType(uint8_t dataType);
+
+/// ZCL callback implemented by the plugin
+boolean emberAfIdentifyClusterIdentifyQueryResponseCallback(int16u timeout);
+/// ZCL callback implemented by the application, the host's passes
+/// responses on to the plugin
+boolean emberAfConfigureReportingResponseCallback(EmberAfClusterId clusterId,
+                                                  int8u *buffer,
+                                                  int16u bufLen);
+
+/// Network helpers
+#ifndef EMBER_SUPPORTED_NETWORKS
+#define EMBER_SUPPORTED_NETWORKS 1
+#endif
+
+typedef struct {
+  EmberNodeType nodeType;
+} EmberAfZigbeeProNetwork;
+
+extern const EmberAfZigbeeProNetwork *emAfCurrentZigbeeProNetwork;
+
+EmberNodeId emberAfGetNodeId(void);
+EmberNetworkStatus emberNetworkState(void);
+EmberStatus emberAfPermitJoin(uint8_t duration, boolean broadcast_mgmt_permit);
+EmberStatus emberAfFindUnusedPanIdAndForm(void);
+EmberStatus emberAfStartSearchForJoinableNetwork(void);
+uint8_t emberAfNetworkIndexFromEndpoint(uint8_t endpoint);
+EmberStatus emberAfPushNetworkIndex(uint8_t network_index);
+EmberStatus emberAfPopNetworkIndex(void);
+/// Network index the stack currently works on (and calls callbacks with)
+uint8_t emberGetCurrentNetwork(void);
+uint32_t emberAfGetShortPollIntervalMsCallback(void);
+/// Search the address, child and neighbor tables for the node's EUI64
+EmberStatus emberLookupEui64ByNodeId(EmberNodeId nodeId,
+                                     EmberEUI64 eui64Return);
+/// Local node's EUI64
+void emberAfGetEui64(EmberEUI64 returnEui64);
+
+/// ZDO binding requests
+#define UNICAST_BINDING 0x03
+#define EMBER_APS_OPTION_RETRY 0x0040
+#define EMBER_APS_OPTION_ENABLE_ROUTE_DISCOVERY 0x0100
+#define EMBER_AF_DEFAULT_APS_OPTIONS \
+  (EMBER_APS_OPTION_RETRY | EMBER_APS_OPTION_ENABLE_ROUTE_DISCOVERY)
+
+typedef uint16_t EmberApsOption;
+typedef uint16_t EmberMulticastId;
+
+/// Ask @target to add a binding from its @sourceEndpoint of @source for
+/// @clusterId to @destinationEndpoint of @destination
+EmberStatus emberBindRequest(EmberNodeId target, EmberEUI64 source,
+                             uint8_t sourceEndpoint, uint16_t clusterId,
+                             uint8_t type, EmberEUI64 destination,
+                             EmberMulticastId groupAddress,
+                             uint8_t destinationEndpoint,
+                             EmberApsOption options);
+
+/// Service discovery
+typedef enum {
+  EMBER_AF_BROADCAST_SERVICE_DISCOVERY_COMPLETE = 0x00,
+  EMBER_AF_BROADCAST_SERVICE_DISCOVERY_RESPONSE_RECEIVED = 0x01,
+  EMBER_AF_UNICAST_SERVICE_DISCOVERY_TIMEOUT = 0x02,
+  EMBER_AF_UNICAST_SERVICE_DISCOVERY_COMPLETE_WITH_RESPONSE = 0x03,
+  EMBER_AF_BROADCAST_SERVICE_DISCOVERY_COMPLETE_WITH_RESPONSE = 0x04,
+  EMBER_AF_UNICAST_SERVICE_DISCOVERY_COMPLETE_WITH_EMPTY_RESPONSE = 0x05,
+  EMBER_AF_BROADCAST_SERVICE_DISCOVERY_COMPLETE_WITH_EMPTY_RESPONSE = 0x06
+} EmberAfServiceDiscoveryStatus;
+
+#define emberAfHaveDiscoveryResponseStatus(status)                      \
+  ((status) == EMBER_AF_UNICAST_SERVICE_DISCOVERY_COMPLETE_WITH_RESPONSE || \
+   (status) == EMBER_AF_BROADCAST_SERVICE_DISCOVERY_RESPONSE_RECEIVED)
+
+typedef struct {
+  EmberAfServiceDiscoveryStatus status;
+  uint16_t zdoRequestClusterId;
+  EmberNodeId matchAddress;
+  const void *responseData;
+} EmberAfServiceDiscoveryResult;
+
+typedef struct {
+  uint16_t inClusterCount;
+  const uint16_t *inClusterList;
+  uint16_t outClusterCount;
+  const uint16_t *outClusterList;
+  uint16_t profileId;
+  uint16_t deviceId;
+  uint8_t endpoint;
+} EmberAfClusterList;
+
+typedef void(EmberAfServiceDiscoveryCallback)(
+    const EmberAfServiceDiscoveryResult *result);
+
+#define SIMPLE_DESCRIPTOR_REQUEST 0x0004
+#define IEEE_ADDRESS_REQUEST 0x0001
+
+EmberStatus emberAfFindClustersByDeviceAndEndpoint(
+    EmberNodeId target, uint8_t target_endpoint,
+    EmberAfServiceDiscoveryCallback *callback);
+EmberStatus emberAfFindIeeeAddress(EmberNodeId short_address,
+                                   EmberAfServiceDiscoveryCallback *callback);
+
+/// Printing
+void emberAfHostPrint(bool newline, const char *format, ...);
+void emberAfPrintLittleEndianEui64(const EmberEUI64 eui64);
+
+#define emberAfDebugPrint(...) emberAfHostPrint(false, __VA_ARGS__)
+#define emberAfDebugPrintln(...) emberAfHostPrint(true, __VA_ARGS__)
+
+#endif  // SILABS_AF_API_HOST_STUB
@@ -0,0 +1,989 @@
+// *******************************************************************
+// * ember-host.c
+// *
+// * Host-side EmberZNet stand-in. Everything runs on a virtual
+// * millisecond clock: stack events and network deliveries are ordered
+// * by their due time and executed by HostStep().
+// *
+// *******************************************************************
+
+#include "ember-host.h"
+#include "simple-commissioning-initiator.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/// Events table generated for the application (af-gen-event.c)
+extern EmberEventData emAfEvents[];
+
+/*! \typedef struct HostTaskEntry
+    \brief Pending task on the virtual clock
+*/
+typedef struct HostTaskEntry {
+  uint32_t time;
+  uint32_t seq;
+  HostTask_t task;
+  uintptr_t arg0;
+  uintptr_t arg1;
+} HostTaskEntry_t;
+
+/// Request kinds packed into a discovery task argument
+enum { HOST_ZDO_IEEE = 0, HOST_ZDO_SIMPLE_DESCRIPTOR = 1 };
+
+#define HOST_NODE_ID_SPACE 0x10000UL
+
+static HostConfig_t config;
+static HostStats_t stats;
+static uint32_t now_ms;
+
+static HostTaskEntry_t *tasks;
+static size_t tasks_len;
+static size_t tasks_cap;
+static uint32_t tasks_seq;
+
+static HostNode_t *nodes;
+static size_t nodes_len;
+static size_t nodes_cap;
+/// Node index + 1 by short ID, 0 if there is no such node
+static uint32_t node_index[HOST_NODE_ID_SPACE];
+
+static EmberBindingTableEntry *bindings;
+static EmberNodeId *binding_node_ids;
+
+/// Token sizes taken from the plugins' token headers, the last entry
+/// (of no tokens) ends the table and keeps it non-empty when no token is
+/// defined
+#define DEFINE_INDEXED_TOKEN(name, type, arraysize, ...) \
+  {sizeof(type), (arraysize)},
+static const struct {
+  size_t size;
+  uint8_t count;
+} token_layout[TOKEN_COUNT + 1] = {
+#define DEFINETOKENS
+#include "simple-commissioning-initiator-tokens.h"
+#undef DEFINETOKENS
+    {0, 0}};
+#undef DEFINE_INDEXED_TOKEN
+static uint8_t *token_data[TOKEN_COUNT + 1];
+uint16_t emberBindingTableSize;
+
+static uint32_t random_state;
+static uint8_t discovery_in_flight;
+static uint8_t network_index_depth;
+static EmberNetworkStatus network_state;
+
+static EmberAfZigbeeProNetwork local_network;
+const EmberAfZigbeeProNetwork *emAfCurrentZigbeeProNetwork = &local_network;
+static const EmberEUI64 local_eui64 = {0x01, 0x00, 0x00, 0x00,
+                                       0x00, 0x00, 0x00, 0xFE};
+
+/// Outgoing command being built by the emberAfFillCommand* API
+static struct {
+  bool identify_query;
+  bool configure_reporting;
+  EmberAfClusterId cluster_id;
+  uint8_t records;
+  uint8_t source_ep;
+  uint8_t destination_ep;
+} outgoing;
+
+/// Configure Reporting requests delivered to nodes and not answered yet
+static uint32_t reporting_in_flight;
+
+/// Incoming command currently dispatched to the application, per thread
+/// so a test might deliver responses from its own
+static __thread EmberApsFrame current_aps;
+static __thread EmberAfClusterCommand current_cmd;
+static __thread bool current_cmd_valid;
+
+// Task heap interface
+static void TaskHeapPush(const HostTaskEntry_t *entry);
+static void TaskHeapPop(HostTaskEntry_t *entry);
+static inline bool TaskBefore(const HostTaskEntry_t *a,
+                              const HostTaskEntry_t *b);
+
+// Simulated network deliveries
+static void CountFrameSent(void);
+static void DeliverIdentifyQueryResponse(uintptr_t node_pos,
+                                         uintptr_t endpoints);
+static void DeliverConfigureReportingResponse(uintptr_t node_endpoint,
+                                              uintptr_t request);
+static void DeliverDiscovery(uintptr_t callback, uintptr_t request);
+static void DeliverBindRequest(uintptr_t node_pos, uintptr_t to_local);
+static void CompleteNetworkAccess(uintptr_t unused0, uintptr_t unused1);
+static EmberStatus StartDiscovery(EmberNodeId target, uint8_t endpoint,
+                                  uint8_t kind,
+                                  EmberAfServiceDiscoveryCallback *callback);
+static bool Transmit(const HostNode_t *node, uint32_t *delay_ms);
+static bool GetNodeEndpoint(const HostNode_t *node, uint8_t endpoint,
+                            HostEndpoint_t *found);
+
+void HostDefaultConfig(HostConfig_t *cfg) {
+  cfg->binding_table_size = 32;
+  cfg->short_poll_ms = 250;
+  cfg->discovery_timeout_ms = 2000;
+  cfg->discovery_states = 4;
+  cfg->node_type = EMBER_COORDINATOR;
+  cfg->network_state = EMBER_JOINED_NETWORK;
+  cfg->seed = 1;
+  cfg->forward_reporting_responses = true;
+  cfg->verbose = false;
+}
+
+void HostInit(const HostConfig_t *cfg) {
+  HostDeinit();
+
+  if (cfg != NULL) {
+    config = *cfg;
+  } else {
+    HostDefaultConfig(&config);
+  }
+
+  memset(&stats, 0, sizeof(stats));
+  now_ms = 0;
+  tasks_seq = 0;
+  random_state = config.seed ? config.seed : 1;
+  discovery_in_flight = 0;
+  reporting_in_flight = 0;
+  network_index_depth = 0;
+  network_state = config.network_state;
+  local_network.nodeType = config.node_type;
+  memset(&outgoing, 0, sizeof(outgoing));
+  current_cmd_valid = false;
+
+  emberBindingTableSize = config.binding_table_size;
+  bindings = calloc(emberBindingTableSize ? emberBindingTableSize : 1,
+                    sizeof(*bindings));
+  binding_node_ids = calloc(emberBindingTableSize ? emberBindingTableSize : 1,
+                            sizeof(*binding_node_ids));
+  assert(bindings != NULL && binding_node_ids != NULL);
+
+  // erased tokens read as zeros
+  for (uint16_t token = 0; token_layout[token].count != 0; ++token) {
+    token_data[token] =
+        calloc(token_layout[token].count, token_layout[token].size);
+    assert(token_data[token] != NULL);
+  }
+
+  for (EmberEventData *ev = emAfEvents; ev->control != NULL; ++ev) {
+    ev->control->status = EMBER_EVENT_INACTIVE;
+    ev->control->timeToExecute = 0;
+  }
+}
+
+void HostDeinit(void) {
+  free(tasks);
+  tasks = NULL;
+  tasks_len = tasks_cap = 0;
+
+  for (size_t i = 0; i < nodes_len; ++i) {
+    node_index[nodes[i].node_id] = 0;
+  }
+  free(nodes);
+  nodes = NULL;
+  nodes_len = nodes_cap = 0;
+
+  free(bindings);
+  free(binding_node_ids);
+  bindings = NULL;
+  binding_node_ids = NULL;
+  emberBindingTableSize = 0;
+
+  for (uint16_t token = 0; token_layout[token].count != 0; ++token) {
+    free(token_data[token]);
+    token_data[token] = NULL;
+  }
+}
+
+bool HostAddNode(const HostNode_t *node) {
+  if (node_index[node->node_id] != 0) {
+    return false;
+  }
+
+  if (nodes_len == nodes_cap) {
+    nodes_cap = nodes_cap ? nodes_cap * 2 : 16;
+    nodes = realloc(nodes, nodes_cap * sizeof(*nodes));
+    assert(nodes != NULL);
+  }
+
+  nodes[nodes_len] = *node;
+  if (node->poll_ms != 0) {
+    nodes[nodes_len].poll_phase_ms = HostRandom() % node->poll_ms;
+  }
+  ++nodes_len;
+  node_index[node->node_id] = (uint32_t)nodes_len;
+
+  return true;
+}
+
+HostNode_t *HostFindNode(EmberNodeId node_id) {
+  uint32_t pos = node_index[node_id];
+
+  return (pos != 0) ? &nodes[pos - 1] : NULL;
+}
+
+void HostSchedule(uint32_t delay_ms, HostTask_t task, uintptr_t arg0,
+                  uintptr_t arg1) {
+  HostTaskEntry_t entry = {.time = now_ms + delay_ms,
+                           .seq = tasks_seq++,
+                           .task = task,
+                           .arg0 = arg0,
+                           .arg1 = arg1};
+  TaskHeapPush(&entry);
+}
+
+/// Find the earliest due event (events win ties with tasks)
+static EmberEventData *NextEvent(uint32_t *due) {
+  EmberEventData *next = NULL;
+
+  for (EmberEventData *ev = emAfEvents; ev->control != NULL; ++ev) {
+    if (ev->control->status != EMBER_EVENT_INACTIVE &&
+        (next == NULL || ev->control->timeToExecute < *due)) {
+      next = ev;
+      *due = ev->control->timeToExecute;
+    }
+  }
+
+  return next;
+}
+
+static bool NextDue(uint32_t *due) {
+  EmberEventData *ev = NextEvent(due);
+
+  if (tasks_len != 0 && (ev == NULL || tasks[0].time < *due)) {
+    *due = tasks[0].time;
+    return true;
+  }
+
+  return ev != NULL;
+}
+
+bool HostStep(void) {
+  uint32_t due = 0;
+  EmberEventData *ev = NextEvent(&due);
+
+  if (tasks_len != 0 && (ev == NULL || tasks[0].time < due)) {
+    HostTaskEntry_t entry;
+    TaskHeapPop(&entry);
+    now_ms = (entry.time > now_ms) ? entry.time : now_ms;
+    entry.task(entry.arg0, entry.arg1);
+
+    return true;
+  }
+
+  if (ev == NULL) {
+    return false;
+  }
+
+  now_ms = (due > now_ms) ? due : now_ms;
+  ++stats.events_run;
+  ev->handler();
+
+  return true;
+}
+
+void HostRunUntilIdle(uint32_t deadline_ms) {
+  uint32_t due = 0;
+
+  while (NextDue(&due) && due <= deadline_ms) {
+    HostStep();
+  }
+}
+
+uint32_t HostRandom(void) {
+  // xorshift32
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 17;
+  random_state ^= random_state << 5;
+
+  return random_state;
+}
+
+uint32_t HostNow(void) { return now_ms; }
+
+const HostStats_t *HostGetStats(void) { return &stats; }
+
+static inline bool TaskBefore(const HostTaskEntry_t *a,
+                              const HostTaskEntry_t *b) {
+  return (a->time != b->time) ? (a->time < b->time) : (a->seq < b->seq);
+}
+
+static void TaskHeapPush(const HostTaskEntry_t *entry) {
+  if (tasks_len == tasks_cap) {
+    tasks_cap = tasks_cap ? tasks_cap * 2 : 64;
+    tasks = realloc(tasks, tasks_cap * sizeof(*tasks));
+    assert(tasks != NULL);
+  }
+
+  size_t pos = tasks_len++;
+
+  while (pos > 0) {
+    size_t parent = (pos - 1) / 2;
+
+    if (!TaskBefore(entry, &tasks[parent])) {
+      break;
+    }
+
+    tasks[pos] = tasks[parent];
+    pos = parent;
+  }
+
+  tasks[pos] = *entry;
+}
+
+static void TaskHeapPop(HostTaskEntry_t *entry) {
+  *entry = tasks[0];
+  HostTaskEntry_t last = tasks[--tasks_len];
+  size_t pos = 0;
+
+  for (;;) {
+    size_t child = 2 * pos + 1;
+
+    if (child >= tasks_len) {
+      break;
+    }
+    if (child + 1 < tasks_len && TaskBefore(&tasks[child + 1], &tasks[child])) {
+      ++child;
+    }
+    if (!TaskBefore(&tasks[child], &last)) {
+      break;
+    }
+
+    tasks[pos] = tasks[child];
+    pos = child;
+  }
+
+  if (tasks_len != 0) {
+    tasks[pos] = last;
+  }
+}
+
+// Event controls
+void emEventControlSetActive(EmberEventControl *event) {
+  event->status = EMBER_EVENT_ZERO_DELAY;
+  event->timeToExecute = now_ms;
+}
+
+void emEventControlSetDelay(EmberEventControl *event, uint32_t delay_ms,
+                            EmberEventUnits units) {
+  event->status = units;
+  event->timeToExecute = now_ms + delay_ms;
+}
+
+uint32_t halCommonGetInt32uMillisecondTick(void) { return now_ms; }
+
+// Binding table
+EmberStatus emberGetBinding(uint16_t index, EmberBindingTableEntry *result) {
+  ++stats.binding_reads;
+
+  if (index >= emberBindingTableSize) {
+    return EMBER_INVALID_BINDING_INDEX;
+  }
+
+  *result = bindings[index];
+
+  return EMBER_SUCCESS;
+}
+
+EmberStatus emberSetBinding(uint16_t index, EmberBindingTableEntry *value) {
+  ++stats.binding_writes;
+
+  if (index >= emberBindingTableSize) {
+    return EMBER_INVALID_BINDING_INDEX;
+  }
+
+  bindings[index] = *value;
+  binding_node_ids[index] = EMBER_NULL_NODE_ID;
+  if (value->type != EMBER_UNUSED_BINDING) {
+    ++stats.bindings_created;
+    stats.last_binding_ms = now_ms;
+  }
+
+  return EMBER_SUCCESS;
+}
+
+EmberStatus emberDeleteBinding(uint16_t index) {
+  ++stats.binding_writes;
+
+  if (index >= emberBindingTableSize) {
+    return EMBER_INVALID_BINDING_INDEX;
+  }
+
+  memset(&bindings[index], 0, sizeof(bindings[index]));
+  binding_node_ids[index] = EMBER_NULL_NODE_ID;
+
+  return EMBER_SUCCESS;
+}
+
+EmberStatus emberClearBindingTable(void) {
+  for (uint16_t i = 0; i < emberBindingTableSize; ++i) {
+    memset(&bindings[i], 0, sizeof(bindings[i]));
+    binding_node_ids[i] = EMBER_NULL_NODE_ID;
+  }
+
+  return EMBER_SUCCESS;
+}
+
+void emberSetBindingRemoteNodeId(uint16_t index, EmberNodeId id) {
+  if (index < emberBindingTableSize) {
+    binding_node_ids[index] = id;
+  }
+}
+
+EmberNodeId emberGetBindingRemoteNodeId(uint16_t index) {
+  return (index < emberBindingTableSize) ? binding_node_ids[index]
+                                         : EMBER_NULL_NODE_ID;
+}
+
+void emberRemoteSetBindingHandler(EmberBindingTableEntry *entry) {
+  // the stack does not tell the index the binding was set at
+  (void)entry;
+  SimpleCommissioningBindingChanged(SIMPLE_COMMISSIONING_UNKNOWN_BINDING);
+}
+
+void emberRemoteDeleteBindingHandler(uint8_t index) {
+  SimpleCommissioningBindingChanged(index);
+}
+
+EmberStatus HostRemoteSetBinding(uint16_t index,
+                                 EmberBindingTableEntry *entry) {
+  EmberStatus status = emberSetBinding(index, entry);
+
+  if (status == EMBER_SUCCESS) {
+    emberRemoteSetBindingHandler(entry);
+  }
+
+  return status;
+}
+
+EmberStatus HostRemoteDeleteBinding(uint8_t index) {
+  EmberStatus status = emberDeleteBinding(index);
+
+  if (status == EMBER_SUCCESS) {
+    emberRemoteDeleteBindingHandler(index);
+  }
+
+  return status;
+}
+
+// Tokens
+void halCommonGetIndexedToken(void *data, uint16_t token, uint8_t index) {
+  assert(token < TOKEN_COUNT && index < token_layout[token].count);
+  ++stats.token_reads;
+  memcpy(data, token_data[token] + index * token_layout[token].size,
+         token_layout[token].size);
+}
+
+void halCommonSetIndexedToken(uint16_t token, uint8_t index, void *data) {
+  assert(token < TOKEN_COUNT && index < token_layout[token].count);
+  ++stats.token_writes;
+  memcpy(token_data[token] + index * token_layout[token].size, data,
+         token_layout[token].size);
+}
+
+// ZCL commands
+static void CountFrameSent(void) {
+  // the default response to an Identify Query response might be sent
+  // from a test's own thread
+  __atomic_add_fetch(&stats.frames_sent, 1, __ATOMIC_RELAXED);
+}
+
+const EmberAfClusterCommand *emberAfCurrentCommand(void) {
+  return current_cmd_valid ? &current_cmd : NULL;
+}
+
+// the application's callback, the plugin leaves it to the application
+boolean emberAfConfigureReportingResponseCallback(EmberAfClusterId clusterId,
+                                                  int8u *buffer,
+                                                  int16u bufLen) {
+  if (!config.forward_reporting_responses) {
+    return false;
+  }
+
+  return SimpleCommissioningConfigureReportingResponse(clusterId, buffer,
+                                                       bufLen);
+}
+
+EmberStatus emberAfSendImmediateDefaultResponse(uint8_t status) {
+  (void)status;
+  CountFrameSent();
+
+  return EMBER_SUCCESS;
+}
+
+void emberAfFillCommandIdentifyClusterIdentifyQuery(void) {
+  outgoing.identify_query = true;
+}
+
+void emberAfFillCommandGlobalClientToServerConfigureReporting(
+    EmberAfClusterId clusterId, uint8_t *attributes,
+    uint16_t attributesLength) {
+  outgoing.configure_reporting = true;
+  outgoing.cluster_id = clusterId;
+  outgoing.records = 0;
+  // direction, attribute ID, data type, min and max intervals, then
+  // the reportable change of analog types
+  for (uint16_t pos = 0; pos + 8 <= attributesLength; ++outgoing.records) {
+    uint8_t data_type = attributes[pos + 3];
+
+    pos += 8;
+    if (emberAfGetAttributeAnalogOrDiscreteType(data_type) ==
+        EMBER_AF_DATA_TYPE_ANALOG) {
+      pos += emberAfGetDataSize(data_type);
+    }
+  }
+}
+
+void emberAfSetCommandEndpoints(uint8_t source_endpoint,
+                                uint8_t destination_endpoint) {
+  outgoing.source_ep = source_endpoint;
+  outgoing.destination_ep = destination_endpoint;
+}
+
+EmberStatus emberAfSendCommandBroadcast(EmberNodeId destination) {
+  (void)destination;
+
+  if (network_state != EMBER_JOINED_NETWORK) {
+    return EMBER_INVALID_CALL;
+  }
+
+  CountFrameSent();
+  ++stats.broadcasts;
+
+  if (outgoing.identify_query) {
+    for (size_t i = 0; i < nodes_len; ++i) {
+      if (nodes[i].identify_time == 0) {
+        continue;
+      }
+      // every endpoint of the node answers on its own
+      for (uint8_t ep = 0; ep <= nodes[i].more_endpoints_count; ++ep) {
+        uint8_t node_ep =
+            ep ? nodes[i].more_endpoints[ep - 1].endpoint : nodes[i].endpoint;
+        uintptr_t endpoints =
+            (uintptr_t)outgoing.source_ep | ((uintptr_t)node_ep << 8);
+        uint32_t delay_ms = 0;
+
+        if (!Transmit(&nodes[i], &delay_ms)) {
+          continue;
+        }
+        HostSchedule(delay_ms, DeliverIdentifyQueryResponse, i, endpoints);
+        if (nodes[i].duplicate_pct != 0 &&
+            HostRandom() % 100 < nodes[i].duplicate_pct) {
+          HostSchedule(delay_ms + nodes[i].rtt_ms / 2,
+                       DeliverIdentifyQueryResponse, i, endpoints);
+        }
+      }
+    }
+  }
+
+  outgoing.identify_query = false;
+
+  return EMBER_SUCCESS;
+}
+
+EmberStatus emberAfSendCommandUnicast(EmberOutgoingMessageType type,
+                                      uint16_t indexOrDestination) {
+  HostNode_t *node = (type == EMBER_OUTGOING_DIRECT)
+                         ? HostFindNode(indexOrDestination)
+                         : NULL;
+
+  if (network_state != EMBER_JOINED_NETWORK) {
+    return EMBER_INVALID_CALL;
+  }
+
+  CountFrameSent();
+
+  if (outgoing.configure_reporting) {
+    uint32_t delay_ms = 0;
+
+    ++stats.configure_reporting_requests;
+    if (node != NULL && Transmit(node, &delay_ms)) {
+      uintptr_t request = (uintptr_t)outgoing.cluster_id |
+                          ((uintptr_t)outgoing.records << 16) |
+                          ((uintptr_t)outgoing.source_ep << 24);
+
+      if (++reporting_in_flight > stats.configure_reporting_peak) {
+        stats.configure_reporting_peak = reporting_in_flight;
+      }
+      // the node's position fits 24 bits as short IDs take 16
+      HostSchedule(delay_ms, DeliverConfigureReportingResponse,
+                   (uintptr_t)(node - nodes) |
+                       ((uintptr_t)outgoing.destination_ep << 24),
+                   request);
+    }
+  }
+
+  outgoing.configure_reporting = false;
+
+  return EMBER_SUCCESS;
+}
+
+static void DeliverConfigureReportingResponse(uintptr_t node_endpoint,
+                                              uintptr_t request) {
+  HostNode_t *node = &nodes[node_endpoint & 0xFFFFFF];
+  // every record is accepted, which a single status byte tells
+  uint8_t status = EMBER_ZCL_STATUS_SUCCESS;
+
+  --reporting_in_flight;
+  node->reporting_records += (uint8_t)((request >> 16) & 0xFF);
+
+  current_aps.profileId = 0x0104;
+  current_aps.clusterId = (uint16_t)(request & 0xFFFF);
+  current_aps.sourceEndpoint = (uint8_t)((node_endpoint >> 24) & 0xFF);
+  current_aps.destinationEndpoint = (uint8_t)((request >> 24) & 0xFF);
+  current_cmd.apsFrame = &current_aps;
+  current_cmd.source = node->node_id;
+  current_cmd.clusterSpecific = false;
+  current_cmd.commandId = ZCL_CONFIGURE_REPORTING_RESPONSE_COMMAND_ID;
+  current_cmd.networkIndex = 0;
+  current_cmd_valid = true;
+
+  emberAfConfigureReportingResponseCallback(current_aps.clusterId, &status,
+                                            1);
+
+  current_cmd_valid = false;
+}
+
+static void DeliverIdentifyQueryResponse(uintptr_t node_pos,
+                                         uintptr_t endpoints) {
+  const HostNode_t *node = &nodes[node_pos];
+
+  HostReceiveIdentifyQueryResponse(node->node_id,
+                                   (uint8_t)((endpoints >> 8) & 0xFF),
+                                   (uint8_t)(endpoints & 0xFF),
+                                   node->identify_time);
+}
+
+void HostReceiveIdentifyQueryResponse(EmberNodeId source, uint8_t source_ep,
+                                      uint8_t destination_ep,
+                                      uint16_t timeout) {
+  current_aps.profileId = 0x0104;
+  current_aps.clusterId = 0x0003;
+  current_aps.sourceEndpoint = source_ep;
+  current_aps.destinationEndpoint = destination_ep;
+  current_cmd.apsFrame = &current_aps;
+  current_cmd.source = source;
+  current_cmd.clusterSpecific = true;
+  current_cmd.commandId = 0x00;
+  current_cmd.networkIndex = 0;
+  current_cmd_valid = true;
+
+  __atomic_add_fetch(&stats.identify_responses, 1, __ATOMIC_RELAXED);
+  emberAfIdentifyClusterIdentifyQueryResponseCallback(timeout);
+
+  current_cmd_valid = false;
+}
+
+uint8_t emberAfGetDataSize(uint8_t dataType) {
+  switch (dataType) {
+    case 0x38:  // semi-precision
+      return 2;
+    case 0x39:  // single precision
+    case 0xE0:  // time of day
+    case 0xE1:  // date
+    case 0xE2:  // UTC time
+      return 4;
+    case 0x3A:  // double precision
+      return 8;
+    default:
+      break;
+  }
+  if (dataType >= 0x08 && dataType <= 0x2F) {
+    // data, boolean, bitmap, unsigned and signed integers of 1 to 8 bytes
+    return (uint8_t)((dataType & 0x07) + 1);
+  }
+  if (dataType == 0x30 || dataType == 0x31) {
+    // enumerations
+    return (uint8_t)(dataType - 0x2F);
+  }
+
+  return 0;
+}
+
+uint8_t emberAfGetAttributeAnalogOrDiscreteType(uint8_t dataType) {
+  if ((dataType >= 0x20 && dataType <= 0x2F) ||
+      (dataType >= 0x38 && dataType <= 0x3A) ||
+      (dataType >= 0xE0 && dataType <= 0xE2)) {
+    return EMBER_AF_DATA_TYPE_ANALOG;
+  }
+
+  return (dataType == 0x00) ? EMBER_AF_DATA_TYPE_NONE
+                            : EMBER_AF_DATA_TYPE_DISCRETE;
+}
+
+// Network
+EmberNodeId emberAfGetNodeId(void) { return 0x0000; }
+
+EmberStatus emberLookupEui64ByNodeId(EmberNodeId nodeId,
+                                     EmberEUI64 eui64Return) {
+  const HostNode_t *node = HostFindNode(nodeId);
+
+  if (node == NULL || !node->in_stack_tables) {
+    return EMBER_ERR_FATAL;
+  }
+
+  MEMCOPY(eui64Return, node->eui64, EUI64_SIZE);
+
+  return EMBER_SUCCESS;
+}
+
+void emberAfGetEui64(EmberEUI64 returnEui64) {
+  MEMCOPY(returnEui64, local_eui64, EUI64_SIZE);
+}
+
+EmberStatus emberBindRequest(EmberNodeId target, EmberEUI64 source,
+                             uint8_t sourceEndpoint, uint16_t clusterId,
+                             uint8_t type, EmberEUI64 destination,
+                             EmberMulticastId groupAddress,
+                             uint8_t destinationEndpoint,
+                             EmberApsOption options) {
+  HostNode_t *node = HostFindNode(target);
+  uint32_t delay_ms = 0;
+  (void)clusterId;
+  (void)groupAddress;
+  (void)destinationEndpoint;
+  (void)options;
+
+  if (network_state != EMBER_JOINED_NETWORK) {
+    return EMBER_INVALID_CALL;
+  }
+
+  CountFrameSent();
+  ++stats.zdo_requests;
+  ++stats.zdo_bind_requests;
+  if (node != NULL && Transmit(node, &delay_ms)) {
+    // the node only binds its own endpoint, the response is not awaited
+    bool to_local = type == UNICAST_BINDING &&
+                    GetNodeEndpoint(node, sourceEndpoint, NULL) &&
+                    MEMCOMPARE(source, node->eui64, EUI64_SIZE) == 0 &&
+                    MEMCOMPARE(destination, local_eui64, EUI64_SIZE) == 0;
+
+    HostSchedule(delay_ms, DeliverBindRequest, (uintptr_t)(node - nodes),
+                 to_local);
+  }
+
+  return EMBER_SUCCESS;
+}
+
+static void DeliverBindRequest(uintptr_t node_pos, uintptr_t to_local) {
+  if (to_local) {
+    ++nodes[node_pos].report_bindings;
+  }
+}
+
+EmberNetworkStatus emberNetworkState(void) { return network_state; }
+
+EmberStatus emberAfPermitJoin(uint8_t duration,
+                              boolean broadcast_mgmt_permit) {
+  (void)duration;
+
+  if (broadcast_mgmt_permit) {
+    CountFrameSent();
+    ++stats.broadcasts;
+  }
+
+  return EMBER_SUCCESS;
+}
+
+EmberStatus emberAfFindUnusedPanIdAndForm(void) {
+  network_state = EMBER_JOINING_NETWORK;
+  HostSchedule(1000, CompleteNetworkAccess, 0, 0);
+
+  return EMBER_SUCCESS;
+}
+
+EmberStatus emberAfStartSearchForJoinableNetwork(void) {
+  return emberAfFindUnusedPanIdAndForm();
+}
+
+static void CompleteNetworkAccess(uintptr_t unused0, uintptr_t unused1) {
+  (void)unused0;
+  (void)unused1;
+  network_state = EMBER_JOINED_NETWORK;
+}
+
+uint8_t emberAfNetworkIndexFromEndpoint(uint8_t endpoint) {
+  (void)endpoint;
+
+  return 0;
+}
+
+EmberStatus emberAfPushNetworkIndex(uint8_t network_index) {
+  (void)network_index;
+  ++network_index_depth;
+
+  return EMBER_SUCCESS;
+}
+
+uint8_t emberGetCurrentNetwork(void) { return 0; }
+
+EmberStatus emberAfPopNetworkIndex(void) {
+  if (network_index_depth == 0) {
+    return EMBER_INVALID_CALL;
+  }
+
+  --network_index_depth;
+
+  return EMBER_SUCCESS;
+}
+
+uint32_t emberAfGetShortPollIntervalMsCallback(void) {
+  return config.short_poll_ms;
+}
+
+// Service discovery
+EmberStatus emberAfFindClustersByDeviceAndEndpoint(
+    EmberNodeId target, uint8_t target_endpoint,
+    EmberAfServiceDiscoveryCallback *callback) {
+  return StartDiscovery(target, target_endpoint, HOST_ZDO_SIMPLE_DESCRIPTOR,
+                        callback);
+}
+
+EmberStatus emberAfFindIeeeAddress(EmberNodeId short_address,
+                                   EmberAfServiceDiscoveryCallback *callback) {
+  return StartDiscovery(short_address, 0, HOST_ZDO_IEEE, callback);
+}
+
+static EmberStatus StartDiscovery(EmberNodeId target, uint8_t endpoint,
+                                  uint8_t kind,
+                                  EmberAfServiceDiscoveryCallback *callback) {
+  if (discovery_in_flight >= config.discovery_states) {
+    ++stats.zdo_rejected;
+    return EMBER_NO_BUFFERS;
+  }
+
+  ++discovery_in_flight;
+  CountFrameSent();
+  ++stats.zdo_requests;
+  if (kind == HOST_ZDO_IEEE) {
+    ++stats.zdo_ieee_requests;
+  } else {
+    ++stats.zdo_simple_descriptor_requests;
+  }
+
+  // the answer is ignored if it comes after the discovery timeout
+  const HostNode_t *node = HostFindNode(target);
+  HostEndpoint_t node_ep;
+  uint32_t delay_ms = 0;
+  bool transmitted = node != NULL && Transmit(node, &delay_ms);
+  if (transmitted && kind == HOST_ZDO_SIMPLE_DESCRIPTOR &&
+      GetNodeEndpoint(node, endpoint, &node_ep)) {
+    delay_ms += node_ep.descriptor_delay_ms;
+  }
+  bool timed_out = !transmitted || delay_ms > config.discovery_timeout_ms;
+  uintptr_t request = (uintptr_t)target | ((uintptr_t)endpoint << 16) |
+                      ((uintptr_t)kind << 24) |
+                      ((uintptr_t)timed_out << 31);
+  HostSchedule(timed_out ? config.discovery_timeout_ms : delay_ms,
+               DeliverDiscovery, (uintptr_t)callback, request);
+
+  return EMBER_SUCCESS;
+}
+
+/// Compute when the answer of @node for a request sent now comes back.
+/// Returns false if either the request or the answer is lost
+static bool Transmit(const HostNode_t *node, uint32_t *delay_ms) {
+  for (uint8_t leg = 0; leg < 2; ++leg) {
+    if (node->loss_pct != 0 && HostRandom() % 100 < node->loss_pct) {
+      ++stats.frames_lost;
+      return false;
+    }
+  }
+
+  uint32_t jitter = node->jitter_ms ? HostRandom() % (node->jitter_ms + 1) : 0;
+  uint32_t arrival = now_ms + node->rtt_ms / 2 + jitter;
+
+  if (node->poll_ms != 0) {
+    // parent holds the frame until the next data poll of its sleepy child
+    uint32_t since_poll = (arrival + node->poll_ms - node->poll_phase_ms %
+                           node->poll_ms) % node->poll_ms;
+    arrival += since_poll ? node->poll_ms - since_poll : 0;
+  }
+
+  *delay_ms = arrival + (node->rtt_ms - node->rtt_ms / 2) - now_ms;
+
+  return true;
+}
+
+/// Look the @endpoint of @node up, its clusters go to @found if it is not
+/// NULL. Returns false if the node has no such endpoint
+static bool GetNodeEndpoint(const HostNode_t *node, uint8_t endpoint,
+                            HostEndpoint_t *found) {
+  HostEndpoint_t node_ep = {node->endpoint, node->in_clusters, node->in_count,
+                            node->out_clusters, node->out_count,
+                            node->descriptor_delay_ms};
+
+  for (uint8_t ep = 0; node_ep.endpoint != endpoint; ++ep) {
+    if (ep == node->more_endpoints_count) {
+      return false;
+    }
+    node_ep = node->more_endpoints[ep];
+  }
+  if (found != NULL) {
+    *found = node_ep;
+  }
+
+  return true;
+}
+
+static void DeliverDiscovery(uintptr_t callback, uintptr_t request) {
+  EmberNodeId target = (EmberNodeId)(request & 0xFFFF);
+  uint8_t endpoint = (uint8_t)((request >> 16) & 0xFF);
+  uint8_t kind = (uint8_t)((request >> 24) & 0x7F);
+  bool timed_out = (request >> 31) & 0x01;
+  const HostNode_t *node = HostFindNode(target);
+  HostEndpoint_t node_ep;
+  EmberAfClusterList clusters;
+  EmberAfServiceDiscoveryResult result = {
+      .status = EMBER_AF_UNICAST_SERVICE_DISCOVERY_COMPLETE_WITH_RESPONSE,
+      .zdoRequestClusterId = (kind == HOST_ZDO_IEEE) ? IEEE_ADDRESS_REQUEST
+                                                     : SIMPLE_DESCRIPTOR_REQUEST,
+      .matchAddress = target,
+      .responseData = NULL};
+
+  --discovery_in_flight;
+
+  if (timed_out || node == NULL) {
+    ++stats.zdo_timeouts;
+    result.status = EMBER_AF_UNICAST_SERVICE_DISCOVERY_TIMEOUT;
+  } else if (kind == HOST_ZDO_IEEE) {
+    result.responseData = node->eui64;
+  } else if (!GetNodeEndpoint(node, endpoint, &node_ep)) {
+    result.status =
+        EMBER_AF_UNICAST_SERVICE_DISCOVERY_COMPLETE_WITH_EMPTY_RESPONSE;
+  } else {
+    clusters.inClusterCount = node_ep.in_count;
+    clusters.inClusterList = node_ep.in_clusters;
+    clusters.outClusterCount = node_ep.out_count;
+    clusters.outClusterList = node_ep.out_clusters;
+    clusters.profileId = 0x0104;
+    clusters.deviceId = 0x0000;
+    clusters.endpoint = node_ep.endpoint;
+    result.responseData = &clusters;
+  }
+
+  ((EmberAfServiceDiscoveryCallback *)callback)(&result);
+}
+
+// Printing
+void emberAfHostPrint(bool newline, const char *format, ...) {
+  if (!config.verbose) {
+    return;
+  }
+
+  va_list args;
+  va_start(args, format);
+  vprintf(format, args);
+  va_end(args);
+
+  if (newline) {
+    putchar('\n');
+  }
+}
+
+void emberAfPrintLittleEndianEui64(const EmberEUI64 eui64) {
+  emberAfHostPrint(false, "(>)%02X%02X%02X%02X%02X%02X%02X%02X", eui64[7],
+                   eui64[6], eui64[5], eui64[4], eui64[3], eui64[2], eui64[1],
+                   eui64[0]);
+}
@@ -0,0 +1,200 @@
+// *******************************************************************
+// * ember-host.h
+// *
+// * Control interface of the host-side EmberZNet stand-in: virtual
+// * clock, event loop, binding table and a table of virtual remote
+// * nodes answering Identify Query, ZDO discovery, Bind and Configure
+// * Reporting requests.
+// *
+// *******************************************************************
+
+#ifndef EMBER_HOST_H
+#define EMBER_HOST_H
+
+#include "app/framework/include/af.h"
+
+/*! \typedef struct HostConfig
+    \brief Simulated stack configuration
+*/
+typedef struct HostConfig {
+  /// Number of entries in the binding table
+  uint16_t binding_table_size;
+  /// Value returned by emberAfGetShortPollIntervalMsCallback()
+  uint32_t short_poll_ms;
+  /// Unicast service discovery timeout (in milliseconds)
+  uint32_t discovery_timeout_ms;
+  /// Number of service discovery requests that might be in flight at once
+  uint8_t discovery_states;
+  /// Local node type
+  EmberNodeType node_type;
+  /// Initial network state
+  EmberNetworkStatus network_state;
+  /// Seed of the pseudo random generator used for jitter and frame loss
+  uint32_t seed;
+  /// Whether the application's Configure Reporting response callback
+  /// passes responses on to the plugin
+  bool forward_reporting_responses;
+  /// Print plugin's debug output
+  bool verbose;
+} HostConfig_t;
+
+/*! \typedef struct HostEndpoint
+    \brief Further application endpoint of a virtual remote node
+*/
+typedef struct HostEndpoint {
+  /// Endpoint number
+  uint8_t endpoint;
+  /// Server clusters list
+  const uint16_t *in_clusters;
+  /// Server clusters list length
+  uint8_t in_count;
+  /// Client clusters list
+  const uint16_t *out_clusters;
+  /// Client clusters list length
+  uint8_t out_count;
+  /// Time the node takes to answer Simple Descriptor requests for
+  /// the endpoint on top of the round trip (in milliseconds)
+  uint32_t descriptor_delay_ms;
+} HostEndpoint_t;
+
+/*! \typedef struct HostNode
+    \brief Virtual remote node
+
+    Cluster lists are referenced, not copied, and must outlive the node
+*/
+typedef struct HostNode {
+  /// Node's short ID
+  EmberNodeId node_id;
+  /// Node's EUI64
+  EmberEUI64 eui64;
+  /// Node's application endpoint
+  uint8_t endpoint;
+  /// Node is in the local address, child or neighbor table, so its EUI64
+  /// is known without asking the network
+  bool in_stack_tables;
+  /// Server clusters list
+  const uint16_t *in_clusters;
+  /// Server clusters list length
+  uint8_t in_count;
+  /// Client clusters list
+  const uint16_t *out_clusters;
+  /// Client clusters list length
+  uint8_t out_count;
+  /// Time the node takes to answer Simple Descriptor requests for
+  /// @endpoint on top of the round trip (in milliseconds)
+  uint32_t descriptor_delay_ms;
+  /// Application endpoints besides @endpoint, each one answers Identify
+  /// Query, Simple Descriptor and Configure Reporting requests on its own.
+  /// The list is referenced, not copied, and must outlive the node
+  const HostEndpoint_t *more_endpoints;
+  /// Number of entries in @more_endpoints
+  uint8_t more_endpoints_count;
+  /// Remaining identify time reported in the Identify Query response,
+  /// node ignores Identify Query if it is zero
+  uint16_t identify_time;
+  /// Request/response round trip time (in milliseconds)
+  uint32_t rtt_ms;
+  /// Upper bound of a random delay added to every round trip
+  uint32_t jitter_ms;
+  /// Probability (in percents) that a frame to or from the node is lost
+  uint8_t loss_pct;
+  /// Probability (in percents) that the node's Identify Query response
+  /// is delivered twice (retried or relayed over two routes)
+  uint8_t duplicate_pct;
+  /// Sleepy end device poll period (in milliseconds), 0 for rx-on nodes.
+  /// Frames for a sleepy node are held by its parent until the next poll
+  uint32_t poll_ms;
+  /// Poll phase relative to the virtual clock origin, set by HostAddNode()
+  uint32_t poll_phase_ms;
+  /// Attribute reporting records configured on the node by Configure
+  /// Reporting requests
+  uint16_t reporting_records;
+  /// Bindings to the local node added on the node by Bind requests
+  uint16_t report_bindings;
+} HostNode_t;
+
+/*! \typedef struct HostStats
+    \brief Counters collected by the simulated stack
+*/
+typedef struct HostStats {
+  /// All frames sent by the local node
+  uint32_t frames_sent;
+  /// Broadcasts sent by the local node
+  uint32_t broadcasts;
+  /// ZDO unicast requests sent by the local node
+  uint32_t zdo_requests;
+  /// Simple Descriptor requests among zdo_requests
+  uint32_t zdo_simple_descriptor_requests;
+  /// IEEE address requests among zdo_requests
+  uint32_t zdo_ieee_requests;
+  /// Bind requests among zdo_requests
+  uint32_t zdo_bind_requests;
+  /// Service discovery requests rejected as no discovery state was free
+  uint32_t zdo_rejected;
+  /// Service discovery requests that timed out
+  uint32_t zdo_timeouts;
+  /// Identify Query responses delivered to the application
+  uint32_t identify_responses;
+  /// Requests and responses lost on air
+  uint32_t frames_lost;
+  /// Configure Reporting requests sent by the local node
+  uint32_t configure_reporting_requests;
+  /// Most Configure Reporting requests awaiting their responses at once
+  uint32_t configure_reporting_peak;
+  /// Bindings written to the binding table
+  uint32_t bindings_created;
+  /// Virtual time of the last binding written
+  uint32_t last_binding_ms;
+  /// emberGetBinding calls
+  uint32_t binding_reads;
+  /// emberSetBinding/emberDeleteBinding calls
+  uint32_t binding_writes;
+  /// halCommonGetIndexedToken calls
+  uint32_t token_reads;
+  /// halCommonSetIndexedToken calls (each one wears the NVM)
+  uint32_t token_writes;
+  /// Event handler invocations
+  uint32_t events_run;
+} HostStats_t;
+
+/// Task scheduled on the virtual clock
+typedef void (*HostTask_t)(uintptr_t arg0, uintptr_t arg1);
+
+/// Fill @config with default values
+void HostDefaultConfig(HostConfig_t *config);
+/// Reset the whole simulated stack (clock, events, bindings, tokens, nodes,
+/// stats)
+/// @config might be NULL for defaults
+void HostInit(const HostConfig_t *config);
+/// Release memory allocated by HostInit() and HostAddNode()
+void HostDeinit(void);
+/// Register a virtual remote node. Returns false on duplicated short ID
+bool HostAddNode(const HostNode_t *node);
+/// Find a registered node by its short ID
+HostNode_t *HostFindNode(EmberNodeId node_id);
+/// Run @task after @delay_ms on the virtual clock
+void HostSchedule(uint32_t delay_ms, HostTask_t task, uintptr_t arg0,
+                  uintptr_t arg1);
+/// Advance the clock to the next pending event or task and run it
+/// Returns false if nothing is pending
+bool HostStep(void);
+/// Run until nothing is pending or the clock passes @deadline_ms
+void HostRunUntilIdle(uint32_t deadline_ms);
+/// Next value of the simulation's pseudo random generator
+uint32_t HostRandom(void);
+/// Deliver an Identify Query response of the remote @source, might be
+/// called from another thread than the one running the stack's events
+void HostReceiveIdentifyQueryResponse(EmberNodeId source, uint8_t source_ep,
+                                      uint8_t destination_ep,
+                                      uint16_t timeout);
+/// Serve a remote node's ZDO Bind request setting the binding @index
+/// to @entry, the application's handler is called as by the stack
+EmberStatus HostRemoteSetBinding(uint16_t index, EmberBindingTableEntry *entry);
+/// Serve a remote node's ZDO Unbind request deleting the binding @index
+EmberStatus HostRemoteDeleteBinding(uint8_t index);
+/// Current virtual time (in milliseconds)
+uint32_t HostNow(void);
+/// Collected counters
+const HostStats_t *HostGetStats(void);
+
+#endif  // EMBER_HOST_H
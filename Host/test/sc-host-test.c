@@ -0,0 +1,1004 @@
+// *******************************************************************
+// * sc-host-test.c
+// *
+// * Regression tests for the Simple Commissioning Initiator plugin
+// * running against the host-side EmberZNet stand-in
+// *
+// *******************************************************************
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+
+#include "ember-host.h"
+#include "simple-commissioning-initiator-buffer.h"
+#include "simple-commissioning-initiator-internal.h"
+#include "simple-commissioning-initiator.h"
+
+/// The plugin's event handler, the stack's events run it
+void emberAfPluginSimpleCommissioningInitiatorStateMachineEventHandler(void);
+
+#define LOCAL_EP 1
+#define REMOTE_EP 10
+#define RUN_LIMIT_MS (10 * 60 * 1000UL)
+/// Remotes passed between the remotes queue's producer and consumer threads
+#define QUEUE_STRESS_REMOTES 200000UL
+/// Remotes answering Identify Query from another thread, all of them fit
+/// the queue as the clock stands still while they answer
+#define THREADED_REMOTES ((QUEUE_SIZE < 16) ? QUEUE_SIZE : 16)
+
+#define CHECK(cond)                                                 \
+  do {                                                              \
+    if (!(cond)) {                                                  \
+      printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+      return false;                                                 \
+    }                                                               \
+  } while (0)
+
+static const uint16_t on_off_server[] = {0x0000, 0x0003, 0x0006};
+static const uint16_t on_off_client[] = {0x0006};
+static const uint16_t level_server[] = {0x0000, 0x0006, 0x0008};
+static const uint16_t level_client[] = {0x0006, 0x0008};
+
+/// Register a light answering Identify Query
+static void AddLight(EmberNodeId node_id, const uint16_t *in_clusters,
+                     uint8_t in_count, bool identifying) {
+  HostNode_t node = {.node_id = node_id,
+                     .endpoint = REMOTE_EP,
+                     .in_clusters = in_clusters,
+                     .in_count = in_count,
+                     .identify_time = identifying ? 60 : 0,
+                     .rtt_ms = 40};
+
+  for (uint8_t i = 0; i < EUI64_SIZE; ++i) {
+    node.eui64[i] = (uint8_t)(node_id >> ((i & 1) * 8)) ^ i;
+  }
+
+  HostAddNode(&node);
+}
+
+/// Count bindings from @local_ep to @remote_ep of @node_id for @cluster_id
+static uint16_t CountBindingsBetween(uint8_t local_ep, EmberNodeId node_id,
+                                     uint8_t remote_ep, uint16_t cluster_id) {
+  const HostNode_t *node = HostFindNode(node_id);
+  EmberBindingTableEntry entry;
+  uint16_t count = 0;
+
+  for (uint16_t i = 0; i < emberBindingTableSize; ++i) {
+    emberGetBinding(i, &entry);
+    if (entry.type == EMBER_UNICAST_BINDING && entry.local == local_ep &&
+        entry.remote == remote_ep && entry.clusterId == cluster_id &&
+        MEMCOMPARE(entry.identifier, node->eui64, EUI64_SIZE) == 0) {
+      ++count;
+    }
+  }
+
+  return count;
+}
+
+/// Count bindings from @local_ep to @node_id for @cluster_id
+static uint16_t CountEndpointBindings(uint8_t local_ep, EmberNodeId node_id,
+                                      uint16_t cluster_id) {
+  return CountBindingsBetween(local_ep, node_id,
+                              HostFindNode(node_id)->endpoint, cluster_id);
+}
+
+/// Count bindings from LOCAL_EP to @node_id for @cluster_id
+static uint16_t CountBindings(EmberNodeId node_id, uint16_t cluster_id) {
+  return CountEndpointBindings(LOCAL_EP, node_id, cluster_id);
+}
+
+static bool RunSession(const uint16_t *clusters, uint8_t length) {
+  CHECK(SimpleCommissioningStart(LOCAL_EP, false, clusters, length) ==
+        EMBER_SUCCESS);
+  HostRunUntilIdle(RUN_LIMIT_MS);
+  CHECK(CommissioningStateMachineStatus() == SC_EZ_STOP);
+
+  return true;
+}
+
+static bool TestBindsIdentifyingRemotes(void) {
+  AddLight(0x1001, on_off_server, COUNTOF(on_off_server), true);
+  AddLight(0x1002, on_off_server, COUNTOF(on_off_server), true);
+  AddLight(0x1003, on_off_server, COUNTOF(on_off_server), true);
+
+  CHECK(RunSession(on_off_client, COUNTOF(on_off_client)));
+  CHECK(CountBindings(0x1001, 0x0006) == 1);
+  CHECK(CountBindings(0x1002, 0x0006) == 1);
+  CHECK(CountBindings(0x1003, 0x0006) == 1);
+
+  return true;
+}
+
+static bool TestBindsEverySupportedCluster(void) {
+  AddLight(0x2001, level_server, COUNTOF(level_server), true);
+
+  CHECK(RunSession(level_client, COUNTOF(level_client)));
+  CHECK(CountBindings(0x2001, 0x0006) == 1);
+  CHECK(CountBindings(0x2001, 0x0008) == 1);
+  CHECK(CountBindings(0x2001, 0x0000) == 0);
+
+  return true;
+}
+
+static bool TestIgnoresDuplicatedLocalClusters(void) {
+  static const uint16_t clusters[] = {0x0008, 0x0006, 0x0008, 0x0300};
+  AddLight(0x2101, level_server, COUNTOF(level_server), true);
+
+  CHECK(RunSession(clusters, COUNTOF(clusters)));
+  CHECK(CountBindings(0x2101, 0x0006) == 1);
+  CHECK(CountBindings(0x2101, 0x0008) == 1);
+
+  return true;
+}
+
+static bool TestBindsRepeatedRemoteClustersOnce(void) {
+  static const uint16_t repeating_server[] = {0x0006, 0x0000, 0x0008,
+                                              0x0006};
+  AddLight(0x2A01, repeating_server, COUNTOF(repeating_server), true);
+  AddLight(0x2A02, repeating_server, COUNTOF(repeating_server), true);
+
+  CHECK(RunSession(level_client, COUNTOF(level_client)));
+  // the second remote reuses the first one's match result
+  CHECK(CountBindings(0x2A01, 0x0006) == 1);
+  CHECK(CountBindings(0x2A01, 0x0008) == 1);
+  CHECK(CountBindings(0x2A02, 0x0006) == 1);
+  CHECK(CountBindings(0x2A02, 0x0008) == 1);
+
+  return true;
+}
+
+static bool TestReusesMatchResultsOfIdenticalRemotes(void) {
+  AddLight(0x2501, level_server, COUNTOF(level_server), true);
+  AddLight(0x2502, level_server, COUNTOF(level_server), true);
+  AddLight(0x2503, on_off_server, COUNTOF(on_off_server), true);
+  SimpleCommissioningClearStats();
+
+  CHECK(RunSession(level_client, COUNTOF(level_client)));
+  CHECK(CountBindings(0x2501, 0x0008) == 1);
+  CHECK(CountBindings(0x2502, 0x0008) == 1);
+  CHECK(CountBindings(0x2503, 0x0006) == 1);
+  CHECK(CountBindings(0x2503, 0x0008) == 0);
+  CHECK(SimpleCommissioningGetStats()->match_results_hits == 1);
+  CHECK(SimpleCommissioningGetStats()->match_results_misses == 2);
+
+  return true;
+}
+
+static bool TestBindsLongClustersLists(void) {
+  static uint16_t clusters[40];
+  HostConfig_t config;
+  HostDefaultConfig(&config);
+  config.binding_table_size = 128;
+  HostInit(&config);
+
+  for (uint16_t i = 0; i < COUNTOF(clusters); ++i) {
+    clusters[i] = (uint16_t)(0x0100 + i);
+  }
+  AddLight(0x2201, clusters, COUNTOF(clusters), true);
+
+  // the local list is as long as LOCAL_CLUSTERS_LIST_LEN allows
+  const uint8_t length = COUNTOF(clusters) < LOCAL_CLUSTERS_LIST_LEN
+                             ? COUNTOF(clusters)
+                             : LOCAL_CLUSTERS_LIST_LEN;
+  CHECK(RunSession(clusters, length));
+  uint16_t bound = 0;
+  for (uint16_t i = 0; i < COUNTOF(clusters); ++i) {
+    bound += CountBindings(0x2201, clusters[i]);
+  }
+  // the remote's clusters list keeps up to INCOMING_DEVICE_CLUSTERS_LIST_LEN
+  CHECK(bound == (length < INCOMING_DEVICE_CLUSTERS_LIST_LEN
+                      ? length
+                      : INCOMING_DEVICE_CLUSTERS_LIST_LEN));
+
+  return true;
+}
+
+static bool TestUsesEUI64FromStackTables(void) {
+  AddLight(0x2301, on_off_server, COUNTOF(on_off_server), true);
+  AddLight(0x2302, on_off_server, COUNTOF(on_off_server), true);
+  HostFindNode(0x2301)->in_stack_tables = true;
+  SimpleCommissioningClearStats();
+
+  CHECK(RunSession(on_off_client, COUNTOF(on_off_client)));
+  CHECK(CountBindings(0x2301, 0x0006) == 1);
+  CHECK(CountBindings(0x2302, 0x0006) == 1);
+  CHECK(HostGetStats()->zdo_ieee_requests == 1);
+  CHECK(SimpleCommissioningGetStats()->eui64_local_hits == 1);
+  CHECK(SimpleCommissioningGetStats()->eui64_local_misses == 1);
+
+  return true;
+}
+
+static bool TestFollowsMeasuredRoundTrips(void) {
+  AddLight(0x2701, on_off_server, COUNTOF(on_off_server), true);
+  AddLight(0x2702, on_off_server, COUNTOF(on_off_server), true);
+
+  CHECK(RunSession(on_off_client, COUNTOF(on_off_client)));
+  CHECK(CountBindings(0x2701, 0x0006) == 1);
+  CHECK(CountBindings(0x2702, 0x0006) == 1);
+
+  const SimpleCommissioningRttEstimator_t *rtt =
+      SimpleCommissioningGetRttEstimator(0);
+  CHECK(rtt != NULL && rtt->samples > 0);
+  // lights answer in 40 ms exactly, the window shrinks from the
+  // poll-based default towards that
+  CHECK((rtt->srtt >> 3) == 40);
+  CHECK(SimpleCommissioningGetResponseWaitTime(0) >= 40);
+  CHECK(SimpleCommissioningGetResponseWaitTime(0) <
+        2 * emberAfGetShortPollIntervalMsCallback() + 100);
+
+  return true;
+}
+
+static bool TestWaitsForExpectedRemotes(void) {
+  AddLight(0x2801, on_off_server, COUNTOF(on_off_server), true);
+  AddLight(0x2802, on_off_server, COUNTOF(on_off_server), true);
+  // answers long after the response wait window
+  HostFindNode(0x2802)->rtt_ms = 400;
+  SimpleCommissioningSetExpectedRemotes(2);
+
+  uint32_t started = halCommonGetInt32uMillisecondTick();
+  bool passed = RunSession(on_off_client, COUNTOF(on_off_client));
+  uint32_t elapsed = halCommonGetInt32uMillisecondTick() - started;
+  SimpleCommissioningSetExpectedRemotes(0);
+
+  CHECK(passed);
+  CHECK(CountBindings(0x2801, 0x0006) == 1);
+  CHECK(CountBindings(0x2802, 0x0006) == 1);
+  // the session is over as soon as both are bound
+  CHECK(elapsed < IDENTIFY_WINDOW_LIMIT);
+
+  return true;
+}
+
+static bool TestWaitsForSleepyResponders(void) {
+  // round trips measured on one-hop lights
+  for (EmberNodeId node_id = 0x4701; node_id <= 0x4706; ++node_id) {
+    AddLight(node_id, on_off_server, COUNTOF(on_off_server), true);
+  }
+  CHECK(RunSession(on_off_client, COUNTOF(on_off_client)));
+  for (EmberNodeId node_id = 0x4701; node_id <= 0x4706; ++node_id) {
+    HostFindNode(node_id)->identify_time = 0;
+  }
+
+  // answers the broadcast once it polls, long after unicast round trips
+  uint32_t sleepy_rtt_ms = 2 * emberAfGetShortPollIntervalMsCallback();
+  AddLight(0x4707, on_off_server, COUNTOF(on_off_server), true);
+  HostFindNode(0x4707)->rtt_ms = sleepy_rtt_ms;
+  CHECK(SimpleCommissioningGetResponseWaitTime(0) < sleepy_rtt_ms);
+
+  CHECK(RunSession(on_off_client, COUNTOF(on_off_client)));
+  CHECK(CountBindings(0x4707, 0x0006) == 1);
+
+  return true;
+}
+
+static bool TestRunsSessionsOnSeveralEndpoints(void) {
+  AddLight(0x2601, level_server, COUNTOF(level_server), true);
+  AddLight(0x2602, on_off_server, COUNTOF(on_off_server), true);
+
+  CHECK(SimpleCommissioningStart(LOCAL_EP, false, on_off_client,
+                                 COUNTOF(on_off_client)) == EMBER_SUCCESS);
+  CHECK(SimpleCommissioningStart(LOCAL_EP, false, on_off_client,
+                                 COUNTOF(on_off_client)) ==
+        EMBER_NETWORK_BUSY);
+#if CONCURRENT_SESSIONS > 1
+  CHECK(SimpleCommissioningStart(LOCAL_EP + 1, false, level_client,
+                                 COUNTOF(level_client)) == EMBER_SUCCESS);
+  HostRunUntilIdle(RUN_LIMIT_MS);
+  CHECK(CommissioningSessionStatus(LOCAL_EP) == SC_EZ_STOP);
+  CHECK(CommissioningSessionStatus(LOCAL_EP + 1) == SC_EZ_STOP);
+  // every session binds its own endpoint to the remotes it has asked
+  CHECK(CountEndpointBindings(LOCAL_EP, 0x2601, 0x0006) == 1);
+  CHECK(CountEndpointBindings(LOCAL_EP, 0x2601, 0x0008) == 0);
+  CHECK(CountEndpointBindings(LOCAL_EP, 0x2602, 0x0006) == 1);
+  CHECK(CountEndpointBindings(LOCAL_EP + 1, 0x2601, 0x0006) == 1);
+  CHECK(CountEndpointBindings(LOCAL_EP + 1, 0x2601, 0x0008) == 1);
+  CHECK(CountEndpointBindings(LOCAL_EP + 1, 0x2602, 0x0006) == 1);
+#else
+  CHECK(SimpleCommissioningStart(LOCAL_EP + 1, false, level_client,
+                                 COUNTOF(level_client)) ==
+        EMBER_NETWORK_BUSY);
+  HostRunUntilIdle(RUN_LIMIT_MS);
+  CHECK(CommissioningStateMachineStatus() == SC_EZ_STOP);
+#endif  // CONCURRENT_SESSIONS > 1
+
+  return true;
+}
+
+static bool TestServesSeveralEndpointsInOneSession(void) {
+  const SimpleCommissioningEndpoint_t endpoints[] = {
+      {LOCAL_EP, on_off_client, COUNTOF(on_off_client), NULL, 0},
+      {LOCAL_EP + 1, level_client, COUNTOF(level_client), NULL, 0}};
+  AddLight(0x2701, level_server, COUNTOF(level_server), true);
+  AddLight(0x2702, on_off_server, COUNTOF(on_off_server), true);
+
+#if SESSION_ENDPOINTS > 1
+  CHECK(SimpleCommissioningStartEndpoints(endpoints, COUNTOF(endpoints)) ==
+        EMBER_SUCCESS);
+  CHECK(SimpleCommissioningStart(LOCAL_EP + 1, false, level_client,
+                                 COUNTOF(level_client)) ==
+        EMBER_NETWORK_BUSY);
+  HostRunUntilIdle(RUN_LIMIT_MS);
+  CHECK(CommissioningStateMachineStatus() == SC_EZ_STOP);
+  CHECK(CountEndpointBindings(LOCAL_EP, 0x2701, 0x0006) == 1);
+  CHECK(CountEndpointBindings(LOCAL_EP, 0x2701, 0x0008) == 0);
+  CHECK(CountEndpointBindings(LOCAL_EP, 0x2702, 0x0006) == 1);
+  CHECK(CountEndpointBindings(LOCAL_EP + 1, 0x2701, 0x0006) == 1);
+  CHECK(CountEndpointBindings(LOCAL_EP + 1, 0x2701, 0x0008) == 1);
+  CHECK(CountEndpointBindings(LOCAL_EP + 1, 0x2702, 0x0006) == 1);
+  // one Identify Query and one discovery per remote serve both endpoints
+  CHECK(HostGetStats()->identify_responses == 2);
+  CHECK(HostGetStats()->zdo_simple_descriptor_requests == 2);
+#else
+  CHECK(SimpleCommissioningStartEndpoints(endpoints, COUNTOF(endpoints)) ==
+        EMBER_BAD_ARGUMENT);
+#endif  // SESSION_ENDPOINTS > 1
+
+  return true;
+}
+
+static bool TestBindsBothRolesInOneSession(void) {
+  static const uint16_t ota_client[] = {0x0019};
+  static const uint16_t switch_client[] = {0x0006, 0x0019};
+  static const uint16_t local_server[] = {0x0006, 0x0019};
+  const SimpleCommissioningEndpoint_t endpoint = {
+      LOCAL_EP, on_off_client, COUNTOF(on_off_client), local_server,
+      COUNTOF(local_server)};
+  // a light with an OTA client and a light switch, On/Off is matched in
+  // both directions with the latter
+  AddLight(0x2801, on_off_server, COUNTOF(on_off_server), true);
+  HostFindNode(0x2801)->out_clusters = ota_client;
+  HostFindNode(0x2801)->out_count = COUNTOF(ota_client);
+  AddLight(0x2802, on_off_server, COUNTOF(on_off_server), true);
+  HostFindNode(0x2802)->out_clusters = switch_client;
+  HostFindNode(0x2802)->out_count = COUNTOF(switch_client);
+
+  CHECK(SimpleCommissioningStartEndpoints(&endpoint, 1) == EMBER_SUCCESS);
+  HostRunUntilIdle(RUN_LIMIT_MS);
+  CHECK(CommissioningStateMachineStatus() == SC_EZ_STOP);
+  CHECK(CountBindings(0x2801, 0x0006) == 1);
+  CHECK(CountBindings(0x2801, 0x0019) == 1);
+  CHECK(CountBindings(0x2802, 0x0006) == 1);
+  CHECK(CountBindings(0x2802, 0x0019) == 1);
+  // both directions come from one descriptor per remote, a cluster
+  // matched in both is bound once
+  CHECK(HostGetStats()->zdo_simple_descriptor_requests == 2);
+
+  return true;
+}
+
+static bool TestConfiguresReportingOfBoundRemotes(void) {
+  static const SimpleCommissioningReporting_t policy[] = {
+      {0x0006, 0x0000, 0x10, 0, 300, 0},
+      {0x0008, 0x0000, 0x20, 1, 300, 5},
+      {0x0008, 0x0001, 0x21, 1, 600, 100},
+      {0x0019, 0x0002, 0x23, 0, 3600, 1}};
+  for (EmberNodeId id = 0x2901; id <= 0x2906; ++id) {
+    AddLight(id, level_server, COUNTOF(level_server), true);
+  }
+  AddLight(0x2907, on_off_server, COUNTOF(on_off_server), true);
+  SimpleCommissioningClearStats();
+
+  SimpleCommissioningSetReportingPolicy(policy, COUNTOF(policy));
+  CHECK(RunSession(level_client, COUNTOF(level_client)));
+  SimpleCommissioningSetReportingPolicy(NULL, 0);
+  CHECK(CountBindings(0x2901, 0x0008) == 1);
+  CHECK(CountBindings(0x2907, 0x0006) == 1);
+#if REPORTING_WINDOW > 0
+  // one request per bound cluster carries all of its attributes
+  // and a binding back to the local endpoint carries the reports
+  for (EmberNodeId id = 0x2901; id <= 0x2906; ++id) {
+    CHECK(HostFindNode(id)->reporting_records == 3);
+    CHECK(HostFindNode(id)->report_bindings == 2);
+  }
+  CHECK(HostFindNode(0x2907)->reporting_records == 1);
+  CHECK(HostFindNode(0x2907)->report_bindings == 1);
+  CHECK(HostGetStats()->zdo_bind_requests == 13);
+  CHECK(HostGetStats()->configure_reporting_requests == 13);
+  CHECK(HostGetStats()->configure_reporting_peak <= REPORTING_WINDOW);
+  CHECK(SimpleCommissioningGetStats()->reporting_requests == 13);
+  CHECK(SimpleCommissioningGetStats()->reporting_timeouts == 0);
+#endif  // REPORTING_WINDOW > 0
+
+  // without a policy the remotes are only bound
+  CHECK(emberClearBindingTable() == EMBER_SUCCESS);
+  CHECK(RunSession(level_client, COUNTOF(level_client)));
+  CHECK(CountBindings(0x2901, 0x0008) == 1);
+  CHECK(HostGetStats()->configure_reporting_requests ==
+        ((REPORTING_WINDOW > 0) ? 13 : 0));
+  CHECK(HostGetStats()->zdo_bind_requests ==
+        ((REPORTING_WINDOW > 0) ? 13 : 0));
+
+  return true;
+}
+
+static bool TestTimesOutUnforwardedReporting(void) {
+#if REPORTING_WINDOW > 0
+  static const SimpleCommissioningReporting_t policy[] = {
+      {0x0006, 0x0000, 0x10, 0, 300, 0},
+      {0x0008, 0x0000, 0x20, 1, 300, 5}};
+  HostConfig_t config;
+  HostDefaultConfig(&config);
+  // the application keeps the responses to itself
+  config.forward_reporting_responses = false;
+  HostInit(&config);
+  for (EmberNodeId id = 0x4801; id <= 0x4803; ++id) {
+    AddLight(id, level_server, COUNTOF(level_server), true);
+  }
+  SimpleCommissioningClearStats();
+
+  SimpleCommissioningSetReportingPolicy(policy, COUNTOF(policy));
+  bool passed = RunSession(level_client, COUNTOF(level_client));
+  SimpleCommissioningSetReportingPolicy(NULL, 0);
+
+  CHECK(passed);
+  CHECK(CountBindings(0x4803, 0x0008) == 1);
+  CHECK(HostFindNode(0x4803)->reporting_records == 2);
+  // every request waits out its response time on its own, and the
+  // discovery wait window doesn't grow for them
+  CHECK(SimpleCommissioningGetStats()->reporting_requests == 6);
+  CHECK(SimpleCommissioningGetStats()->reporting_timeouts == 6);
+  CHECK(SimpleCommissioningGetRttEstimator(0)->backoff == 0);
+#endif  // REPORTING_WINDOW > 0
+
+  return true;
+}
+
+static bool TestServesCachedDescriptors(void) {
+#if DESCRIPTOR_CACHE_SIZE > 0
+  AddLight(0x2401, on_off_server, COUNTOF(on_off_server), true);
+  AddLight(0x2402, on_off_server, COUNTOF(on_off_server), true);
+  HostFindNode(0x2402)->in_stack_tables = true;
+
+  CHECK(RunSession(on_off_client, COUNTOF(on_off_client)));
+  uint32_t descriptor_requests =
+      HostGetStats()->zdo_simple_descriptor_requests;
+  uint32_t ieee_requests = HostGetStats()->zdo_ieee_requests;
+
+  // commissioning known remotes again costs no Simple Descriptor requests,
+  // the EUI64 of the remote the stack doesn't know is still asked for
+  CHECK(emberClearBindingTable() == EMBER_SUCCESS);
+  SimpleCommissioningClearStats();
+  CHECK(RunSession(on_off_client, COUNTOF(on_off_client)));
+  CHECK(CountBindings(0x2401, 0x0006) == 1);
+  CHECK(CountBindings(0x2402, 0x0006) == 1);
+  CHECK(HostGetStats()->zdo_simple_descriptor_requests ==
+        descriptor_requests);
+  CHECK(HostGetStats()->zdo_ieee_requests == ieee_requests + 1);
+  CHECK(SimpleCommissioningGetStats()->descriptor_cache_hits == 2);
+  CHECK(SimpleCommissioningGetStats()->descriptor_cache_stale == 0);
+
+  // another remote has got the short ID, the stack's tables tell so
+  HostNode_t *node = HostFindNode(0x2401);
+  node->eui64[0] ^= 0xFF;
+  node->in_stack_tables = true;
+  CHECK(RunSession(on_off_client, COUNTOF(on_off_client)));
+  CHECK(CountBindings(0x2401, 0x0006) == 1);
+  CHECK(HostGetStats()->zdo_simple_descriptor_requests == 3);
+#endif  // DESCRIPTOR_CACHE_SIZE > 0
+
+  return true;
+}
+
+static bool TestChecksDescriptorsCachedByShortId(void) {
+#if DESCRIPTOR_CACHE_SIZE > 0
+  static const uint16_t level_only_client[] = {0x0008};
+
+  AddLight(0x4501, level_server, COUNTOF(level_server), true);
+  AddLight(0x4502, on_off_server, COUNTOF(on_off_server), true);
+
+  CHECK(RunSession(level_client, COUNTOF(level_client)));
+  CHECK(CountBindings(0x4501, 0x0008) == 1);
+  CHECK(CountBindings(0x4502, 0x0006) == 1);
+
+  // other remotes have got the short IDs and the stack doesn't know them.
+  // The cached descriptors are served first, whether they match or not,
+  // the IEEE address responses tell they are not the remotes'
+  HostNode_t *node = HostFindNode(0x4501);
+  node->eui64[0] ^= 0xFF;
+  node->in_clusters = on_off_server;
+  node->in_count = COUNTOF(on_off_server);
+  node = HostFindNode(0x4502);
+  node->eui64[0] ^= 0xFF;
+  node->in_clusters = level_server;
+  node->in_count = COUNTOF(level_server);
+  CHECK(emberClearBindingTable() == EMBER_SUCCESS);
+  SimpleCommissioningClearStats();
+  uint32_t descriptor_requests =
+      HostGetStats()->zdo_simple_descriptor_requests;
+
+  CHECK(RunSession(level_only_client, COUNTOF(level_only_client)));
+  CHECK(CountBindings(0x4501, 0x0008) == 0);
+  CHECK(CountBindings(0x4502, 0x0008) == 1);
+  CHECK(SimpleCommissioningGetStats()->descriptor_cache_stale == 2);
+  CHECK(HostGetStats()->zdo_simple_descriptor_requests ==
+        descriptor_requests + 2);
+
+  // the short IDs serve the new remotes' descriptors now
+  CHECK(emberClearBindingTable() == EMBER_SUCCESS);
+  SimpleCommissioningClearStats();
+  CHECK(RunSession(level_only_client, COUNTOF(level_only_client)));
+  CHECK(CountBindings(0x4501, 0x0008) == 0);
+  CHECK(CountBindings(0x4502, 0x0008) == 1);
+  CHECK(SimpleCommissioningGetStats()->descriptor_cache_hits == 2);
+  CHECK(SimpleCommissioningGetStats()->descriptor_cache_stale == 0);
+  CHECK(HostGetStats()->zdo_simple_descriptor_requests ==
+        descriptor_requests + 2);
+#endif  // DESCRIPTOR_CACHE_SIZE > 0
+
+  return true;
+}
+
+#if DESCRIPTOR_CACHE_SIZE > 0
+/// Count entries of the descriptors cache holding the @endpoint of the
+/// remote with @node_id's EUI64
+static uint8_t CountCachedDescriptors(EmberNodeId node_id, uint8_t endpoint) {
+  const HostNode_t *node = HostFindNode(node_id);
+  tokTypeSimpleCommissioningDescriptor descriptor;
+  uint8_t count = 0;
+
+  for (uint8_t i = 0; i < DESCRIPTOR_CACHE_SIZE; ++i) {
+    halCommonGetIndexedToken(&descriptor,
+                             TOKEN_SIMPLE_COMMISSIONING_DESCRIPTORS, i);
+    if ((descriptor.flags & SIMPLE_COMMISSIONING_DESCRIPTOR_VALID) &&
+        descriptor.endpoint == endpoint &&
+        MEMCOMPARE(descriptor.eui64, node->eui64, EUI64_SIZE) == 0) {
+      ++count;
+    }
+  }
+
+  return count;
+}
+#endif  // DESCRIPTOR_CACHE_SIZE > 0
+
+static bool TestKeepsOneCachedDescriptorPerRemote(void) {
+#if DESCRIPTOR_CACHE_SIZE > 0
+  AddLight(0x4901, on_off_server, COUNTOF(on_off_server), true);
+  AddLight(0x4902, on_off_server, COUNTOF(on_off_server), true);
+  CHECK(RunSession(on_off_client, COUNTOF(on_off_client)));
+
+  // both remotes rejoin with short IDs the stack doesn't know
+  AddLight(0x4911, on_off_server, COUNTOF(on_off_server), true);
+  AddLight(0x4912, on_off_server, COUNTOF(on_off_server), true);
+  MEMCOPY(HostFindNode(0x4911)->eui64, HostFindNode(0x4901)->eui64,
+          EUI64_SIZE);
+  MEMCOPY(HostFindNode(0x4912)->eui64, HostFindNode(0x4902)->eui64,
+          EUI64_SIZE);
+  HostFindNode(0x4901)->identify_time = 0;
+  HostFindNode(0x4902)->identify_time = 0;
+  // the EUI64 of one of them comes before its descriptor
+  HostFindNode(0x4912)->descriptor_delay_ms = 200;
+  CHECK(emberClearBindingTable() == EMBER_SUCCESS);
+  uint32_t token_writes = HostGetStats()->token_writes;
+
+  CHECK(RunSession(on_off_client, COUNTOF(on_off_client)));
+  CHECK(CountBindings(0x4911, 0x0006) == 1);
+  CHECK(CountBindings(0x4912, 0x0006) == 1);
+  CHECK(CountCachedDescriptors(0x4911, REMOTE_EP) == 1);
+  CHECK(CountCachedDescriptors(0x4912, REMOTE_EP) == 1);
+#ifdef EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_CONCURRENT_LOOKUPS
+  // the entry that got the new short ID holds the same descriptor, it
+  // is not written again. The other remote's descriptor is cached anew,
+  // gets its EUI64 and the old entry is evicted
+  CHECK(HostGetStats()->token_writes == token_writes + 4);
+#endif
+  (void)token_writes;
+#endif  // DESCRIPTOR_CACHE_SIZE > 0
+
+  return true;
+}
+
+static bool TestSkipsExistingBindings(void) {
+  AddLight(0x3001, on_off_server, COUNTOF(on_off_server), true);
+
+  CHECK(RunSession(on_off_client, COUNTOF(on_off_client)));
+  CHECK(RunSession(on_off_client, COUNTOF(on_off_client)));
+  CHECK(CountBindings(0x3001, 0x0006) == 1);
+
+  return true;
+}
+
+static bool TestSkipsBindingsMadeByApplication(void) {
+  AddLight(0x3101, level_server, COUNTOF(level_server), true);
+
+  const HostNode_t *node = HostFindNode(0x3101);
+  EmberBindingTableEntry entry = {.type = EMBER_UNICAST_BINDING,
+                                  .local = LOCAL_EP,
+                                  .clusterId = 0x0008,
+                                  .remote = REMOTE_EP};
+  MEMCOPY(entry.identifier, node->eui64, EUI64_SIZE);
+  CHECK(emberSetBinding(emberBindingTableSize - 1, &entry) == EMBER_SUCCESS);
+
+  CHECK(RunSession(level_client, COUNTOF(level_client)));
+  CHECK(CountBindings(0x3101, 0x0006) == 1);
+  CHECK(CountBindings(0x3101, 0x0008) == 1);
+
+  return true;
+}
+
+/// Binding of the local endpoint's @cluster_id to the light @node_id
+static EmberBindingTableEntry MakeLightBinding(EmberNodeId node_id,
+                                               uint16_t cluster_id) {
+  EmberBindingTableEntry entry = {.type = EMBER_UNICAST_BINDING,
+                                  .local = LOCAL_EP,
+                                  .clusterId = cluster_id,
+                                  .remote = REMOTE_EP};
+  MEMCOPY(entry.identifier, HostFindNode(node_id)->eui64, EUI64_SIZE);
+
+  return entry;
+}
+
+/// Add bindings to the light @node_id for @cluster_id at the binding
+/// table's index 5 and for the Color Control cluster at the index 0,
+/// the application reports both to the plugin
+static void AddBindingsBehindPlugin(uintptr_t node_id, uintptr_t cluster_id) {
+  EmberBindingTableEntry entry =
+      MakeLightBinding((EmberNodeId)node_id, 0x0300);
+  emberSetBinding(0, &entry);
+  SimpleCommissioningBindingChanged(0);
+  entry.clusterId = (uint16_t)cluster_id;
+  emberSetBinding(5, &entry);
+  SimpleCommissioningBindingChanged(5);
+}
+
+static bool TestSkipsBindingsAddedDuringSession(void) {
+  AddLight(0x3301, level_server, COUNTOF(level_server), true);
+  // the session has read the binding table by then, the light has not
+  // answered Identify Query yet
+  HostSchedule(1, AddBindingsBehindPlugin, 0x3301, 0x0008);
+
+  CHECK(RunSession(level_client, COUNTOF(level_client)));
+  CHECK(CountBindings(0x3301, 0x0300) == 1);
+  CHECK(CountBindings(0x3301, 0x0006) == 1);
+  CHECK(CountBindings(0x3301, 0x0008) == 1);
+
+  return true;
+}
+
+/// A remote node's ZDO Bind request sets the binding of @cluster_id to
+/// the light @node_id at the binding table's index 7
+static void BindRemotely(uintptr_t node_id, uintptr_t cluster_id) {
+  EmberBindingTableEntry entry =
+      MakeLightBinding((EmberNodeId)node_id, (uint16_t)cluster_id);
+  HostRemoteSetBinding(7, &entry);
+}
+
+static bool TestSkipsBindingsBoundRemotely(void) {
+  AddLight(0x4A01, level_server, COUNTOF(level_server), true);
+  // the stack does not tell the index, and it is not the lowest unused one
+  HostSchedule(1, BindRemotely, 0x4A01, 0x0008);
+
+  CHECK(RunSession(level_client, COUNTOF(level_client)));
+  CHECK(CountBindings(0x4A01, 0x0006) == 1);
+  CHECK(CountBindings(0x4A01, 0x0008) == 1);
+
+  // a remote Unbind request is reported as well, the next session binds
+  // the cluster again
+  CHECK(HostRemoteDeleteBinding(7) == EMBER_SUCCESS);
+  CHECK(RunSession(level_client, COUNTOF(level_client)));
+  CHECK(CountBindings(0x4A01, 0x0006) == 1);
+  CHECK(CountBindings(0x4A01, 0x0008) == 1);
+
+  return true;
+}
+
+#ifndef EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_BINDING_CHANGES_REPORTED
+/// Add a binding to the light @node_id for @cluster_id at the binding
+/// table's index 9 without telling the plugin
+static void AddUnreportedBinding(uintptr_t node_id, uintptr_t cluster_id) {
+  EmberBindingTableEntry entry =
+      MakeLightBinding((EmberNodeId)node_id, (uint16_t)cluster_id);
+  emberSetBinding(9, &entry);
+}
+#endif
+
+static bool TestScansForUnreportedBindings(void) {
+#ifndef EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_BINDING_CHANGES_REPORTED
+  AddLight(0x4A11, level_server, COUNTOF(level_server), true);
+  HostSchedule(1, AddUnreportedBinding, 0x4A11, 0x0008);
+
+  CHECK(RunSession(level_client, COUNTOF(level_client)));
+  CHECK(CountBindings(0x4A11, 0x0006) == 1);
+  CHECK(CountBindings(0x4A11, 0x0008) == 1);
+#endif
+
+  return true;
+}
+
+static bool TestFillsBindingTable(void) {
+  HostConfig_t config;
+  HostDefaultConfig(&config);
+  config.binding_table_size = 3;
+  HostInit(&config);
+  AddLight(0x3201, level_server, COUNTOF(level_server), true);
+  AddLight(0x3202, level_server, COUNTOF(level_server), true);
+
+  CHECK(RunSession(level_client, COUNTOF(level_client)));
+  CHECK(CountBindings(0x3201, 0x0006) + CountBindings(0x3201, 0x0008) +
+            CountBindings(0x3202, 0x0006) + CountBindings(0x3202, 0x0008) ==
+        3);
+
+  // a deleted binding leaves a hole the next session fills
+  CHECK(emberDeleteBinding(1) == EMBER_SUCCESS);
+  CHECK(RunSession(level_client, COUNTOF(level_client)));
+  CHECK(CountBindings(0x3201, 0x0006) + CountBindings(0x3201, 0x0008) +
+            CountBindings(0x3202, 0x0006) + CountBindings(0x3202, 0x0008) ==
+        3);
+
+  return true;
+}
+
+static bool TestDropsDuplicatedResponses(void) {
+  AddLight(0x4101, on_off_server, COUNTOF(on_off_server), true);
+  HostFindNode(0x4101)->duplicate_pct = 100;
+
+  CHECK(RunSession(on_off_client, COUNTOF(on_off_client)));
+  CHECK(CountBindings(0x4101, 0x0006) == 1);
+  CHECK(HostGetStats()->identify_responses == 2);
+  CHECK(HostGetStats()->zdo_simple_descriptor_requests == 1);
+
+  return true;
+}
+
+static bool TestDiscoversEndpointsOfOneRemote(void) {
+  // the dimmer answers its Simple Descriptor request after the switch's
+  // one sent later. Remotes are discovered one by one unless the Discovery
+  // window lets them overtake each other
+  static const HostEndpoint_t endpoints[] = {
+      {REMOTE_EP + 1, level_server, COUNTOF(level_server), NULL, 0, 100},
+      {REMOTE_EP + 2, on_off_server, COUNTOF(on_off_server), NULL, 0, 0}};
+  for (EmberNodeId id = 0x4601; id <= 0x4602; ++id) {
+    AddLight(id, on_off_server, COUNTOF(on_off_server), true);
+    HostFindNode(id)->more_endpoints = endpoints;
+    HostFindNode(id)->more_endpoints_count = COUNTOF(endpoints);
+    HostFindNode(id)->in_stack_tables = true;
+  }
+
+  CHECK(RunSession(level_client, COUNTOF(level_client)));
+  for (EmberNodeId id = 0x4601; id <= 0x4602; ++id) {
+    CHECK(CountBindingsBetween(LOCAL_EP, id, REMOTE_EP, 0x0006) == 1);
+    CHECK(CountBindingsBetween(LOCAL_EP, id, REMOTE_EP + 1, 0x0006) == 1);
+    CHECK(CountBindingsBetween(LOCAL_EP, id, REMOTE_EP + 1, 0x0008) == 1);
+    CHECK(CountBindingsBetween(LOCAL_EP, id, REMOTE_EP + 2, 0x0006) == 1);
+    CHECK(CountBindingsBetween(LOCAL_EP, id, REMOTE_EP + 2, 0x0008) == 0);
+  }
+  CHECK(HostGetStats()->zdo_simple_descriptor_requests == 6);
+
+  return true;
+}
+
+static bool TestGivesUpRemotesTheStackCannotDiscover(void) {
+  HostConfig_t config;
+  HostDefaultConfig(&config);
+  // every service discovery request is refused
+  config.discovery_states = 0;
+  HostInit(&config);
+  AddLight(0x4401, on_off_server, COUNTOF(on_off_server), true);
+
+  CHECK(RunSession(on_off_client, COUNTOF(on_off_client)));
+  CHECK(CountBindings(0x4401, 0x0006) == 0);
+  CHECK(HostGetStats()->zdo_rejected > 1);
+
+  return true;
+}
+
+static bool TestIgnoresNotIdentifyingRemotes(void) {
+  AddLight(0x4001, on_off_server, COUNTOF(on_off_server), true);
+  AddLight(0x4002, on_off_server, COUNTOF(on_off_server), false);
+
+  CHECK(RunSession(on_off_client, COUNTOF(on_off_client)));
+  CHECK(CountBindings(0x4001, 0x0006) == 1);
+  CHECK(CountBindings(0x4002, 0x0006) == 0);
+
+  return true;
+}
+
+static bool TestQueuesHundredsOfRemotes(void) {
+#if QUEUE_SIZE > 127
+  const uint16_t lights = 300;
+  HostConfig_t config;
+  HostDefaultConfig(&config);
+  config.binding_table_size = 512;
+  HostInit(&config);
+
+  for (uint16_t i = 0; i < lights; ++i) {
+    AddLight((EmberNodeId)(0x4201 + i), on_off_server,
+             COUNTOF(on_off_server), true);
+  }
+
+  CHECK(RunSession(on_off_client, COUNTOF(on_off_client)));
+  // one Identify Query round, no response is dropped for a full queue
+  CHECK(HostGetStats()->identify_responses == lights);
+  CHECK(HostGetStats()->zdo_simple_descriptor_requests == lights);
+  for (uint16_t i = 0; i < lights; ++i) {
+    CHECK(CountBindings((EmberNodeId)(0x4201 + i), 0x0006) == 1);
+  }
+#endif  // QUEUE_SIZE > 127
+
+  return true;
+}
+
+static bool TestRejectsBadArguments(void) {
+  CHECK(SimpleCommissioningStart(LOCAL_EP, false, NULL, 1) ==
+        EMBER_BAD_ARGUMENT);
+  CHECK(SimpleCommissioningStart(LOCAL_EP, false, on_off_client, 0) ==
+        EMBER_BAD_ARGUMENT);
+  const SimpleCommissioningEndpoint_t no_server = {
+      LOCAL_EP, on_off_client, COUNTOF(on_off_client), NULL, 1};
+  CHECK(SimpleCommissioningStartEndpoints(&no_server, 1) ==
+        EMBER_BAD_ARGUMENT);
+  // one cluster more than the matcher has positions for
+  static uint16_t clusters[LOCAL_CLUSTERS_LIST_LEN];
+  const SimpleCommissioningEndpoint_t too_long = {
+      LOCAL_EP, clusters, LOCAL_CLUSTERS_LIST_LEN, on_off_client, 1};
+  CHECK(SimpleCommissioningStartEndpoints(&too_long, 1) == EMBER_BAD_ARGUMENT);
+
+  return true;
+}
+
+static MatchDescriptorQueue_t stress_queue;
+
+/// Identify Query responses' side of the remotes queue
+static void *QueueStressProducer(void *arg) {
+  for (uint32_t i = 0; i < QUEUE_STRESS_REMOTES;) {
+    if (AddInDeviceDescriptor(&stress_queue, (EmberNodeId)i,
+                              (uint8_t)(i >> 16))) {
+      ++i;
+    } else {
+      sched_yield();
+    }
+  }
+
+  return arg;
+}
+
+static bool TestPassesRemotesBetweenThreads(void) {
+  pthread_t producer;
+  uint32_t misplaced = 0;
+  uint32_t overfilled = 0;
+
+  InitQueue(&stress_queue);
+  CHECK(pthread_create(&producer, NULL, QueueStressProducer, NULL) == 0);
+
+  // the consumer has to drain the queue whatever it finds, the producer
+  // would never stop otherwise
+  for (uint32_t i = 0; i < QUEUE_STRESS_REMOTES;) {
+    MatchDescriptorReq_t *top = GetTopInDeviceDescriptor(&stress_queue);
+
+    if (top == NULL) {
+      sched_yield();
+      continue;
+    }
+    if (GetQueueSize(&stress_queue) > QUEUE_SIZE) {
+      ++overfilled;
+    }
+    if (top->source != (EmberNodeId)i || top->source_ep != (uint8_t)(i >> 16) ||
+        top->stage != SC_REMOTE_NEW || top->clusters.count != 0) {
+      ++misplaced;
+    }
+    // leftovers the producer has to overwrite on the slot's next use
+    top->stage = SC_REMOTE_DONE;
+    top->clusters.count = 1;
+    PopInDeviceDescriptor(&stress_queue);
+    ++i;
+  }
+
+  CHECK(pthread_join(producer, NULL) == 0);
+  CHECK(misplaced == 0);
+  CHECK(overfilled == 0);
+  CHECK(GetTopInDeviceDescriptor(&stress_queue) == NULL);
+
+  return true;
+}
+
+static bool responder_done;
+
+/// Identify Query responses' thread, every remote answers twice
+static void *IdentifyResponder(void *arg) {
+  for (uint8_t round = 0; round < 2; ++round) {
+    for (uint16_t i = 0; i < THREADED_REMOTES; ++i) {
+      HostReceiveIdentifyQueryResponse((EmberNodeId)(0x4B01 + i), REMOTE_EP,
+                                       LOCAL_EP, 60);
+      sched_yield();
+    }
+  }
+  __atomic_store_n(&responder_done, true, __ATOMIC_RELEASE);
+
+  return arg;
+}
+
+static bool TestCollectsResponsesFromAnotherThread(void) {
+  pthread_t responder;
+
+  // the stack delivers no responses of its own, the responder's thread
+  // answers for the remotes
+  for (uint16_t i = 0; i < THREADED_REMOTES; ++i) {
+    AddLight((EmberNodeId)(0x4B01 + i), on_off_server,
+             COUNTOF(on_off_server), false);
+  }
+  __atomic_store_n(&responder_done, false, __ATOMIC_RELEASE);
+
+  CHECK(SimpleCommissioningStart(LOCAL_EP, false, on_off_client,
+                                 COUNTOF(on_off_client)) == EMBER_SUCCESS);
+  while (CommissioningSessionStatus(LOCAL_EP) != SC_EZ_WAIT_IDENT_RESP) {
+    CHECK(HostStep());
+  }
+
+  CHECK(pthread_create(&responder, NULL, IdentifyResponder, NULL) == 0);
+  // the clock stands still, so the session keeps collecting while its
+  // event handler runs over and over against the callback
+  while (!__atomic_load_n(&responder_done, __ATOMIC_ACQUIRE)) {
+    emberAfPluginSimpleCommissioningInitiatorStateMachineEventHandler();
+  }
+  CHECK(pthread_join(responder, NULL) == 0);
+
+  HostRunUntilIdle(RUN_LIMIT_MS);
+  CHECK(CommissioningStateMachineStatus() == SC_EZ_STOP);
+  CHECK(HostGetStats()->identify_responses == 2 * THREADED_REMOTES);
+  for (uint16_t i = 0; i < THREADED_REMOTES; ++i) {
+    CHECK(CountBindings((EmberNodeId)(0x4B01 + i), 0x0006) == 1);
+  }
+
+  return true;
+}
+
+static const struct {
+  const char *name;
+  bool (*run)(void);
+} tests[] = {
+    {"BindsIdentifyingRemotes", TestBindsIdentifyingRemotes},
+    {"BindsEverySupportedCluster", TestBindsEverySupportedCluster},
+    {"IgnoresDuplicatedLocalClusters", TestIgnoresDuplicatedLocalClusters},
+    {"BindsRepeatedRemoteClustersOnce", TestBindsRepeatedRemoteClustersOnce},
+    {"ReusesMatchResultsOfIdenticalRemotes",
+     TestReusesMatchResultsOfIdenticalRemotes},
+    {"BindsLongClustersLists", TestBindsLongClustersLists},
+    {"UsesEUI64FromStackTables", TestUsesEUI64FromStackTables},
+    {"FollowsMeasuredRoundTrips", TestFollowsMeasuredRoundTrips},
+    {"WaitsForExpectedRemotes", TestWaitsForExpectedRemotes},
+    {"WaitsForSleepyResponders", TestWaitsForSleepyResponders},
+    {"RunsSessionsOnSeveralEndpoints", TestRunsSessionsOnSeveralEndpoints},
+    {"ServesSeveralEndpointsInOneSession",
+     TestServesSeveralEndpointsInOneSession},
+    {"BindsBothRolesInOneSession", TestBindsBothRolesInOneSession},
+    {"ConfiguresReportingOfBoundRemotes",
+     TestConfiguresReportingOfBoundRemotes},
+    {"TimesOutUnforwardedReporting", TestTimesOutUnforwardedReporting},
+    {"ServesCachedDescriptors", TestServesCachedDescriptors},
+    {"ChecksDescriptorsCachedByShortId", TestChecksDescriptorsCachedByShortId},
+    {"KeepsOneCachedDescriptorPerRemote",
+     TestKeepsOneCachedDescriptorPerRemote},
+    {"SkipsExistingBindings", TestSkipsExistingBindings},
+    {"SkipsBindingsMadeByApplication", TestSkipsBindingsMadeByApplication},
+    {"SkipsBindingsAddedDuringSession", TestSkipsBindingsAddedDuringSession},
+    {"SkipsBindingsBoundRemotely", TestSkipsBindingsBoundRemotely},
+    {"ScansForUnreportedBindings", TestScansForUnreportedBindings},
+    {"FillsBindingTable", TestFillsBindingTable},
+    {"DropsDuplicatedResponses", TestDropsDuplicatedResponses},
+    {"DiscoversEndpointsOfOneRemote", TestDiscoversEndpointsOfOneRemote},
+    {"GivesUpRemotesTheStackCannotDiscover",
+     TestGivesUpRemotesTheStackCannotDiscover},
+    {"IgnoresNotIdentifyingRemotes", TestIgnoresNotIdentifyingRemotes},
+    {"QueuesHundredsOfRemotes", TestQueuesHundredsOfRemotes},
+    {"RejectsBadArguments", TestRejectsBadArguments},
+    {"PassesRemotesBetweenThreads", TestPassesRemotesBetweenThreads},
+    {"CollectsResponsesFromAnotherThread",
+     TestCollectsResponsesFromAnotherThread},
+};
+
+int main(void) {
+  int failed = 0;
+
+  for (size_t i = 0; i < COUNTOF(tests); ++i) {
+    HostInit(NULL);
+    bool passed = tests[i].run();
+    printf("[%s] %s\n", passed ? "PASS" : "FAIL", tests[i].name);
+    failed += passed ? 0 : 1;
+  }
+
+  HostDeinit();
+
+  return failed ? 1 : 0;
+}
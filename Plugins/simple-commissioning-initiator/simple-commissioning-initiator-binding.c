@@ -0,0 +1,419 @@
+// *******************************************************************
+// * simple-commissioning-initiator-binding.c
+// *
+// * RAM mirror of the stack's binding table with a hash index over
+// * (local endpoint, cluster, remote endpoint, EUI64), so checking
+// * a remote's cluster for an existing binding costs one token read
+// * for a hit and none for a miss as long as binding changes made
+// * behind the plugin's back are reported to it
+// *
+// *******************************************************************
+
+#include "simple-commissioning-initiator-binding.h"
+#include "simple-commissioning-initiator-bits.h"
+
+/// Open addressing index keeps at least a half of its slots empty,
+/// so a probe sequence stays short. Slots in use are a power of two
+/// between 2 and 4 times the stack's run time table size
+#define BINDING_INDEX_SLOTS (4 * EMBER_BINDING_TABLE_SIZE)
+/// Free-slot bitmap words
+#define BINDING_BITMAP_WORDS ((EMBER_BINDING_TABLE_SIZE + 31) / 32)
+#define BINDING_SLOT_EMPTY 0xFFFF
+#define BINDING_SLOT_DELETED 0xFFFE
+
+/*! \typedef struct BindingMirrorEntry
+    \brief Binding table entry's fields used for duplicate detection
+*/
+typedef struct BindingMirrorEntry {
+  EmberBindingType type;
+  uint8_t local;
+  uint8_t remote;
+  uint16_t cluster_id;
+  EmberEUI64 identifier;
+} BindingMirrorEntry_t;
+
+/*! \typedef struct BindingMirror
+    \brief Copy of the binding table, the hash index over it and
+    the bitmap of unused entries
+*/
+typedef struct BindingMirror {
+  /// Mirrored binding table entries
+  BindingMirrorEntry_t entries[EMBER_BINDING_TABLE_SIZE];
+  /// Binding indices by hash, BINDING_SLOT_EMPTY or BINDING_SLOT_DELETED
+  uint16_t slots[BINDING_INDEX_SLOTS];
+  /// Number of slots in use less one, depends on emberBindingTableSize
+  uint16_t slot_mask;
+  /// Number of BINDING_SLOT_DELETED slots
+  uint16_t deleted;
+  /// Set bits mark unused binding table entries
+  uint32_t free_bitmap[BINDING_BITMAP_WORDS];
+  /// Lowest free_bitmap word that might have a set bit
+  uint16_t free_hint;
+  /// Number of set bits in free_bitmap
+  uint16_t free_count;
+  /// Mirror holds the whole stack's table
+  bool valid;
+  /// Bindings were set at indices the mirror does not know
+  bool stale;
+} BindingMirror_t;
+
+static BindingMirror_t binding_mirror;
+
+// Mirror private interface
+static inline uint16_t HashBinding(const uint8_t local,
+                                   const uint16_t cluster_id,
+                                   const uint8_t remote,
+                                   const EmberEUI64 identifier);
+static inline uint16_t HashMirrorEntry(const BindingMirrorEntry_t *mirrored);
+static inline bool IsSameBinding(const BindingMirrorEntry_t *mirrored,
+                                 const EmberBindingTableEntry *const entry);
+static inline bool IsSameTableEntry(const EmberBindingTableEntry *current,
+                                    const EmberBindingTableEntry *const entry);
+static inline void MirrorEntry(const uint16_t index,
+                               const EmberBindingTableEntry *const entry);
+static inline void MarkBindingFree(const uint16_t index, const bool is_free);
+static void IndexInsert(const uint16_t index);
+static void IndexRemove(const uint16_t index);
+static void IndexRebuild(void);
+static uint16_t ScanBindingTable(const EmberBindingTableEntry *const entry);
+static uint16_t ScanForUnusedBinding(uint16_t *const count);
+static uint16_t LowestMirroredUnusedBinding(void);
+static void RefreshStaleMirror(void);
+
+static inline uint16_t HashBinding(const uint8_t local,
+                                   const uint16_t cluster_id,
+                                   const uint8_t remote,
+                                   const EmberEUI64 identifier) {
+  // 32-bit FNV-1a over the key fields
+  uint32_t hash = 2166136261UL;
+
+  hash = (hash ^ local) * 16777619UL;
+  hash = (hash ^ LOW_BYTE(cluster_id)) * 16777619UL;
+  hash = (hash ^ HIGH_BYTE(cluster_id)) * 16777619UL;
+  hash = (hash ^ remote) * 16777619UL;
+  for (uint8_t i = 0; i < EUI64_SIZE; ++i) {
+    hash = (hash ^ identifier[i]) * 16777619UL;
+  }
+
+  return (uint16_t)((hash ^ (hash >> 16)) & binding_mirror.slot_mask);
+}
+
+static inline uint16_t HashMirrorEntry(const BindingMirrorEntry_t *mirrored) {
+  return HashBinding(mirrored->local, mirrored->cluster_id, mirrored->remote,
+                     mirrored->identifier);
+}
+
+static inline bool IsSameBinding(const BindingMirrorEntry_t *mirrored,
+                                 const EmberBindingTableEntry *const entry) {
+  return mirrored->type != EMBER_UNUSED_BINDING &&
+         mirrored->local == entry->local &&
+         mirrored->cluster_id == entry->clusterId &&
+         mirrored->remote == entry->remote &&
+         MEMCOMPARE(mirrored->identifier, entry->identifier, EUI64_SIZE) == 0;
+}
+
+static inline bool IsSameTableEntry(const EmberBindingTableEntry *current,
+                                    const EmberBindingTableEntry *const entry) {
+  return current->type != EMBER_UNUSED_BINDING &&
+         current->local == entry->local &&
+         current->clusterId == entry->clusterId &&
+         current->remote == entry->remote &&
+         MEMCOMPARE(current->identifier, entry->identifier, EUI64_SIZE) == 0;
+}
+
+static inline void MirrorEntry(const uint16_t index,
+                               const EmberBindingTableEntry *const entry) {
+  BindingMirrorEntry_t *mirrored = &binding_mirror.entries[index];
+
+  mirrored->type = entry->type;
+  mirrored->local = entry->local;
+  mirrored->remote = entry->remote;
+  mirrored->cluster_id = entry->clusterId;
+  MEMCOPY(mirrored->identifier, entry->identifier, EUI64_SIZE);
+}
+
+static inline void MarkBindingFree(const uint16_t index, const bool is_free) {
+  uint16_t word = index / 32;
+  uint32_t bit = 1UL << (index % 32);
+
+  if (is_free == !!(binding_mirror.free_bitmap[word] & bit)) {
+    return;
+  }
+
+  binding_mirror.free_bitmap[word] ^= bit;
+  if (is_free) {
+    ++binding_mirror.free_count;
+    if (word < binding_mirror.free_hint) {
+      binding_mirror.free_hint = word;
+    }
+  } else {
+    --binding_mirror.free_count;
+  }
+}
+
+static void IndexInsert(const uint16_t index) {
+  uint16_t slot = HashMirrorEntry(&binding_mirror.entries[index]);
+
+  // the index has more slots than the table has entries, so there is
+  // always a free one
+  while (binding_mirror.slots[slot] != BINDING_SLOT_EMPTY &&
+         binding_mirror.slots[slot] != BINDING_SLOT_DELETED) {
+    slot = (slot + 1) & binding_mirror.slot_mask;
+  }
+
+  if (binding_mirror.slots[slot] == BINDING_SLOT_DELETED) {
+    --binding_mirror.deleted;
+  }
+  binding_mirror.slots[slot] = index;
+}
+
+static void IndexRemove(const uint16_t index) {
+  uint16_t slot = HashMirrorEntry(&binding_mirror.entries[index]);
+
+  while (binding_mirror.slots[slot] != BINDING_SLOT_EMPTY) {
+    if (binding_mirror.slots[slot] == index) {
+      // keep probe sequences running through the slot unbroken
+      binding_mirror.slots[slot] = BINDING_SLOT_DELETED;
+      ++binding_mirror.deleted;
+      break;
+    }
+    slot = (slot + 1) & binding_mirror.slot_mask;
+  }
+}
+
+static void IndexRebuild(void) {
+  for (uint32_t slot = 0; slot <= binding_mirror.slot_mask; ++slot) {
+    binding_mirror.slots[slot] = BINDING_SLOT_EMPTY;
+  }
+  binding_mirror.deleted = 0;
+
+  for (uint16_t i = 0; i < emberBindingTableSize; ++i) {
+    if (binding_mirror.entries[i].type != EMBER_UNUSED_BINDING) {
+      IndexInsert(i);
+    }
+  }
+}
+
+static uint16_t ScanBindingTable(const EmberBindingTableEntry *const entry) {
+  EmberBindingTableEntry current = {0};
+
+  for (uint16_t i = 0; i < emberBindingTableSize; ++i) {
+    if (emberGetBinding(i, &current) != EMBER_SUCCESS) {
+      break;
+    }
+    if (IsSameTableEntry(&current, entry)) {
+      return i;
+    }
+  }
+
+  return BINDING_NOT_FOUND;
+}
+
+static uint16_t ScanForUnusedBinding(uint16_t *const count) {
+  EmberBindingTableEntry current = {0};
+  uint16_t first = BINDING_NOT_FOUND;
+
+  *count = 0;
+  for (uint16_t i = 0; i < emberBindingTableSize; ++i) {
+    if (emberGetBinding(i, &current) != EMBER_SUCCESS) {
+      // something bad happened with Binding Table
+      emberAfDebugPrintln("DEBUG: error: cannot get the binding entry");
+      break;
+    }
+    if (current.type == EMBER_UNUSED_BINDING) {
+      first = (first == BINDING_NOT_FOUND) ? i : first;
+      ++*count;
+    }
+  }
+
+  return first;
+}
+
+static uint16_t LowestMirroredUnusedBinding(void) {
+  if (binding_mirror.free_count == 0) {
+    // Binding table is full
+    return BINDING_NOT_FOUND;
+  }
+
+  // words below the hint have no set bits, so the search is amortized O(1)
+  // as long as bindings are allocated from the beginning of the table
+  for (uint16_t word = binding_mirror.free_hint; word < BINDING_BITMAP_WORDS;
+       ++word) {
+    if (binding_mirror.free_bitmap[word] != 0) {
+      binding_mirror.free_hint = word;
+      return (uint16_t)(word * 32 +
+                        FindFirstSetBit(binding_mirror.free_bitmap[word]));
+    }
+  }
+
+  return BINDING_NOT_FOUND;
+}
+
+static void RefreshStaleMirror(void) {
+  if (binding_mirror.valid && binding_mirror.stale) {
+    // bindings were set at indices nobody told us, read the whole table
+    InitBindingMirror();
+  }
+}
+
+// Public interface implementation
+void InitBindingMirror(void) {
+  EmberBindingTableEntry entry = {0};
+
+  binding_mirror.valid = false;
+  binding_mirror.stale = false;
+  if (emberBindingTableSize > EMBER_BINDING_TABLE_SIZE) {
+    emberAfDebugPrintln("DEBUG: binding table too big for the mirror");
+    return;
+  }
+
+  binding_mirror.slot_mask = 1;
+  while (binding_mirror.slot_mask < 2 * (uint32_t)emberBindingTableSize) {
+    binding_mirror.slot_mask = (uint16_t)(binding_mirror.slot_mask << 1 | 1);
+  }
+  MEMSET(binding_mirror.free_bitmap, 0, sizeof(binding_mirror.free_bitmap));
+  binding_mirror.free_hint = 0;
+  binding_mirror.free_count = 0;
+
+  for (uint16_t i = 0; i < emberBindingTableSize; ++i) {
+    if (emberGetBinding(i, &entry) != EMBER_SUCCESS) {
+      // the table is not readable, keep scanning it on every lookup
+      return;
+    }
+    MirrorEntry(i, &entry);
+    MarkBindingFree(i, entry.type == EMBER_UNUSED_BINDING);
+  }
+
+  IndexRebuild();
+  binding_mirror.valid = true;
+}
+
+uint16_t FindBinding(const EmberBindingTableEntry *const entry) {
+  if (!binding_mirror.valid) {
+    return ScanBindingTable(entry);
+  }
+
+  uint16_t slot = HashBinding(entry->local, entry->clusterId, entry->remote,
+                              entry->identifier);
+
+  while (binding_mirror.slots[slot] != BINDING_SLOT_EMPTY) {
+    uint16_t index = binding_mirror.slots[slot];
+
+    if (index != BINDING_SLOT_DELETED &&
+        IsSameBinding(&binding_mirror.entries[index], entry)) {
+      // one read confirms the hit, if the binding was changed behind
+      // our back bring the mirror in sync and look again
+      EmberBindingTableEntry current = {0};
+      if (emberGetBinding(index, &current) == EMBER_SUCCESS &&
+          IsSameTableEntry(&current, entry)) {
+        return index;
+      }
+
+      SyncMirroredBinding(index);
+      return FindBinding(entry);
+    }
+    slot = (slot + 1) & binding_mirror.slot_mask;
+  }
+
+  if (binding_mirror.stale) {
+    RefreshStaleMirror();
+    return FindBinding(entry);
+  }
+
+#ifdef EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_BINDING_CHANGES_REPORTED
+  // every change made behind our back is reported, so the miss is trusted
+  return BINDING_NOT_FOUND;
+#else
+  // a binding set behind our back might be at any index, only the whole
+  // table confirms the miss
+  uint16_t index = ScanBindingTable(entry);
+  if (index != BINDING_NOT_FOUND) {
+    SyncMirroredBinding(index);
+  }
+
+  return index;
+#endif
+}
+
+void UpdateMirroredBinding(const uint16_t index,
+                           const EmberBindingTableEntry *const entry) {
+  if (!binding_mirror.valid || index >= emberBindingTableSize) {
+    // nothing to keep in sync, the next session reads the whole table
+    return;
+  }
+
+  if (binding_mirror.entries[index].type != EMBER_UNUSED_BINDING) {
+    IndexRemove(index);
+  }
+
+  MirrorEntry(index, entry);
+  MarkBindingFree(index, entry->type == EMBER_UNUSED_BINDING);
+
+  if (entry->type != EMBER_UNUSED_BINDING) {
+    IndexInsert(index);
+  }
+
+  if (binding_mirror.deleted > binding_mirror.slot_mask / 4) {
+    // too much tombstones make lookups for missing bindings long
+    IndexRebuild();
+  }
+}
+
+void SyncMirroredBinding(const uint16_t index) {
+  EmberBindingTableEntry entry = {0};
+
+  if (!binding_mirror.valid) {
+    return;
+  }
+
+  if (emberGetBinding(index, &entry) != EMBER_SUCCESS) {
+    // do not trust the mirror anymore
+    binding_mirror.valid = false;
+    return;
+  }
+
+  UpdateMirroredBinding(index, &entry);
+}
+
+void MarkBindingMirrorStale(void) {
+  binding_mirror.stale = true;
+}
+
+uint16_t FindUnusedBinding(void) {
+  uint16_t count = 0;
+
+  if (!binding_mirror.valid) {
+    return ScanForUnusedBinding(&count);
+  }
+
+  uint16_t index = LowestMirroredUnusedBinding();
+  EmberBindingTableEntry current = {0};
+
+  // one read confirms the entry is still unused, one set behind our back
+  // is brought in sync and the next one is tried
+  while (index != BINDING_NOT_FOUND) {
+    if (emberGetBinding(index, &current) != EMBER_SUCCESS) {
+      binding_mirror.valid = false;
+      return ScanForUnusedBinding(&count);
+    }
+    if (current.type == EMBER_UNUSED_BINDING) {
+      return index;
+    }
+    UpdateMirroredBinding(index, &current);
+    index = LowestMirroredUnusedBinding();
+  }
+
+  return BINDING_NOT_FOUND;
+}
+
+uint16_t GetUnusedBindingsCount(void) {
+  uint16_t count = 0;
+
+  RefreshStaleMirror();
+  if (!binding_mirror.valid) {
+    ScanForUnusedBinding(&count);
+    return count;
+  }
+
+  return binding_mirror.free_count;
+}
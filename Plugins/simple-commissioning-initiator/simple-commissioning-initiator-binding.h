@@ -0,0 +1,36 @@
+#ifndef SIMPLE_COMMISSIONING_INITIATOR_BINDING_H
+#define SIMPLE_COMMISSIONING_INITIATOR_BINDING_H
+
+#include "app/framework/include/af.h"
+
+/// Returned by FindBinding() and FindUnusedBinding() if the table has no
+/// such binding
+#define BINDING_NOT_FOUND 0xFFFF
+
+/// Functions for working with the RAM mirror of the binding table
+/// Read the whole stack's binding table into the mirror, called on every
+/// session start. If the stack's table does not fit EMBER_BINDING_TABLE_SIZE
+/// the mirror stays disabled and lookups fall back to scanning the table
+void InitBindingMirror(void);
+/// Find a used binding with the same local endpoint, cluster, remote
+/// endpoint and EUI64 as @entry (its type is not compared). Hits are
+/// confirmed with the stack's table, misses too unless the option Binding
+/// changes reported is set. Returns the binding index or BINDING_NOT_FOUND
+uint16_t FindBinding(const EmberBindingTableEntry *const entry);
+/// Let the mirror know the binding @index was just set to @entry
+void UpdateMirroredBinding(const uint16_t index,
+                           const EmberBindingTableEntry *const entry);
+/// Re-read the binding @index from the stack after it was changed
+/// behind the plugin's back
+void SyncMirroredBinding(const uint16_t index);
+/// Let the mirror know bindings were set at unknown indices, the whole
+/// table is read again before the next miss or unused bindings count
+void MarkBindingMirrorStale(void);
+/// Lowest index of an unused binding, BINDING_NOT_FOUND if the table is full.
+/// The index is confirmed unused by the stack and stays so until the binding
+/// is set and the mirror updated
+uint16_t FindUnusedBinding(void);
+/// Number of unused bindings in the table
+uint16_t GetUnusedBindingsCount(void);
+
+#endif  // SIMPLE_COMMISSIONING_INITIATOR_BINDING_H
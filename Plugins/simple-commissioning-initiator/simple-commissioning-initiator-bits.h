@@ -0,0 +1,33 @@
+#ifndef SIMPLE_COMMISSIONING_INITIATOR_BITS_H
+#define SIMPLE_COMMISSIONING_INITIATOR_BITS_H
+
+#include <stdint.h>
+
+/// Bit operations on 32-bit bitmap words, compiler builtins where
+/// available (CLZ/RBIT on Cortex-M3 and newer)
+/// Number of set bits in @word
+static inline uint8_t CountSetBits(uint32_t word) {
+#if defined(__GNUC__)
+  return (uint8_t)__builtin_popcount(word);
+#else
+  word = word - ((word >> 1) & 0x55555555UL);
+  word = (word & 0x33333333UL) + ((word >> 2) & 0x33333333UL);
+  return (uint8_t)((((word + (word >> 4)) & 0x0F0F0F0FUL) * 0x01010101UL) >>
+                   24);
+#endif
+}
+
+/// Position of the lowest set bit in @word, @word must not be zero
+static inline uint8_t FindFirstSetBit(const uint32_t word) {
+#if defined(__GNUC__)
+  return (uint8_t)__builtin_ctz(word);
+#else
+  uint8_t bit = 0;
+  while (!(word & (1UL << bit))) {
+    ++bit;
+  }
+  return bit;
+#endif
+}
+
+#endif  // SIMPLE_COMMISSIONING_INITIATOR_BITS_H
@@ -1,129 +1,334 @@
 #include "simple-commissioning-initiator-buffer.h"
 
-/// \typedef QUEUE_SIZE
-///
-/// Handy renaming of the long name
-/// EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_REMOTES_QUEUE
-#define QUEUE_SIZE EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_REMOTES_QUEUE
 #define RING_BUFFER_ERROR 255
-
-MatchDescriptorReq_t data[QUEUE_SIZE];
-
-// Internal container for remote devices' Match Descriptors
-// Simple Ring Buffer
-typedef struct RingBuffer {
-  MatchDescriptorReq_t *buffer;
-  uint8_t begin;
-  uint8_t end;
-  uint8_t size;
-  uint8_t capacity;
-} RingBuffer_t;
-
-// Remote Devices queue
-typedef struct MatchDescriptorQueue {
-  RingBuffer_t internal_data;
-} MatchDescriptorQueue_t;
-
-// Global queue
-MatchDescriptorQueue_t devices_queue;
+#define RECENT_SLOT_EMPTY QUEUE_INDEX_MAX
 
 // Queue private interface
 static inline void InitQueueInternalData(MatchDescriptorQueue_t *queue);
-static inline bool QueueIsFull(MatchDescriptorQueue_t *queue);
+static inline uint8_t LoadByte(const uint8_t *value);
+static inline void StoreByte(uint8_t *value, const uint8_t byte);
+static inline void SyncRecentRemotes(MatchDescriptorQueue_t *queue);
+
+// Recent remotes interface
+static inline uint32_t RecentRemoteKey(const EmberNodeId short_id,
+                                       const uint8_t endpoint);
+static inline uint16_t RecentRemoteHash(const uint32_t key);
+static inline void RecentRemotesInit(RecentRemotes_t *recent);
+static uint16_t RecentRemotesFind(const RecentRemotes_t *recent,
+                                  const uint32_t key);
+static void RecentRemotesAdd(RecentRemotes_t *recent, const uint32_t key);
+static void RecentRemotesRemoveSlot(RecentRemotes_t *recent, uint16_t slot);
 
 // Ring Buffer interface
-static inline void RingBufferInit(RingBuffer_t *buf);
-static inline bool RingBufferIsFull(RingBuffer_t *buf);
-static inline bool RingBufferIsEmpty(RingBuffer_t *buf);
-static inline uint8_t RingBufferSize(RingBuffer_t *buf);
-static inline uint8_t RingBufferPush(RingBuffer_t *buf,
-                                     const MatchDescriptorReq_t *const data);
+static inline QueueIndex_t LoadIndex(const QueueIndex_t *index);
+static inline void StoreIndex(QueueIndex_t *index, const QueueIndex_t value);
+static inline void RingBufferInit(RingBuffer_t *buf,
+                                  MatchDescriptorReq_t *storage,
+                                  const QueueIndex_t slots,
+                                  const QueueIndex_t capacity);
+static inline QueueIndex_t RingBufferSize(const RingBuffer_t *buf);
+static inline MatchDescriptorReq_t *RingBufferReserve(RingBuffer_t *buf);
+static inline void RingBufferPush(RingBuffer_t *buf);
 static inline uint8_t RingBufferPopFront(RingBuffer_t *buf);
 static inline void *RingBufferGet(RingBuffer_t *buf);
+static inline void *RingBufferGetAt(RingBuffer_t *buf,
+                                    const QueueIndex_t pos);
 
-static inline void RingBufferInit(RingBuffer_t *buf) {
-  buf->buffer = data;
-  buf->begin = 0;
-  buf->end = 0;
-  buf->size = 0;
-  buf->capacity = QUEUE_SIZE;
+#if QUEUE_SLOTS > (QUEUE_INDEX_MAX / 2 + 1)
+#error "free running ring indices need at least twice the number of slots"
+#endif
+
+#if RECENT_SLOTS < 2 * RECENT_REMOTES
+#error "the recent remotes' index must be at most half full"
+#endif
+
+/// Queued remotes have no padding but the tails listed in td.h
+typedef char MatchDescriptorReqIsPacked[
+    (sizeof(MatchDescriptorReq_t) ==
+     sizeof(SMContext_t) + 2 * sizeof(uint32_t) + sizeof(RemoteClusters_t) +
+         sizeof(EmberNodeId) + EUI64_SIZE + 4 + 2) ? 1 : -1];
+
+/// Indices the other side reads: loads acquire and stores release, so
+/// a slot is filled before the producer publishes it and read before the
+/// consumer gives it back
+static inline QueueIndex_t LoadIndex(const QueueIndex_t *index) {
+#if defined(__GNUC__)
+  return __atomic_load_n(index, __ATOMIC_ACQUIRE);
+#else
+  // no ordering guarantees, the producer and the consumer have to share
+  // a context
+  return *(const volatile QueueIndex_t *)index;
+#endif
 }
-static inline bool RingBufferIsFull(RingBuffer_t *buf) {
-  return (buf->size == buf->capacity);
+
+static inline void StoreIndex(QueueIndex_t *index, const QueueIndex_t value) {
+#if defined(__GNUC__)
+  __atomic_store_n(index, value, __ATOMIC_RELEASE);
+#else
+  *(volatile QueueIndex_t *)index = value;
+#endif
 }
 
-static inline bool RingBufferIsEmpty(RingBuffer_t *buf) {
-  return (buf->size == 0);
+static inline void RingBufferInit(RingBuffer_t *buf,
+                                  MatchDescriptorReq_t *storage,
+                                  const QueueIndex_t slots,
+                                  const QueueIndex_t capacity) {
+  buf->buffer = storage;
+  StoreIndex(&buf->head, 0);
+  StoreIndex(&buf->tail, 0);
+  buf->mask = slots - 1;
+  buf->capacity = capacity;
 }
 
-static inline uint8_t RingBufferSize(RingBuffer_t *buf) { return buf->size; }
+static inline QueueIndex_t RingBufferSize(const RingBuffer_t *buf) {
+  // head first, the tail read after it is never behind it
+  const QueueIndex_t head = LoadIndex(&buf->head);
 
-static inline uint8_t RingBufferPush(RingBuffer_t *buf,
-                                     const MatchDescriptorReq_t *const data) {
-  // Cicular buffer is full
-  if (RingBufferIsFull(buf)) {
+  return (QueueIndex_t)(LoadIndex(&buf->tail) - head);
+}
+
+static inline MatchDescriptorReq_t *RingBufferReserve(RingBuffer_t *buf) {
+  // producer side, tail is its own
+  const QueueIndex_t tail = buf->tail;
+
+  if ((QueueIndex_t)(tail - LoadIndex(&buf->head)) >= buf->capacity) {
     // quit with an error
-    return RING_BUFFER_ERROR;
+    return NULL;
   }
 
-  ++buf->size;
-  buf->buffer[buf->end] = *data;
-  buf->end = (buf->end + 1) % buf->capacity;
+  // the caller fills the slot in place, nothing is copied. The consumer
+  // sees it after RingBufferPush
+  return &buf->buffer[tail & buf->mask];
+}
 
-  return 0;
+static inline void RingBufferPush(RingBuffer_t *buf) {
+  StoreIndex(&buf->tail, (QueueIndex_t)(buf->tail + 1));
 }
 
 static inline uint8_t RingBufferPopFront(RingBuffer_t *buf) {
-  // if the head isn't ahead of the tail, we don't have any characters
-  if (RingBufferIsEmpty(buf)) {
+  // consumer side, head is its own
+  const QueueIndex_t head = buf->head;
+
+  if (LoadIndex(&buf->tail) == head) {
     return RING_BUFFER_ERROR;
   }
 
-  --buf->size;
-  buf->begin = (buf->begin + 1) % buf->capacity;
+  StoreIndex(&buf->head, (QueueIndex_t)(head + 1));
 
   return 0;
 }
 
 static inline void *RingBufferGet(RingBuffer_t *buf) {
-  if (RingBufferIsEmpty(buf)) {
+  return RingBufferGetAt(buf, 0);
+}
+
+static inline void *RingBufferGetAt(RingBuffer_t *buf,
+                                    const QueueIndex_t pos) {
+  const QueueIndex_t head = buf->head;
+
+  if (pos >= (QueueIndex_t)(LoadIndex(&buf->tail) - head)) {
     // quit with an error
     return NULL;
   }
 
-  return &buf->buffer[buf->begin];
+  return &buf->buffer[(QueueIndex_t)(head + pos) & buf->mask];
+}
+
+static inline uint32_t RecentRemoteKey(const EmberNodeId short_id,
+                                       const uint8_t endpoint) {
+  return ((uint32_t)short_id << 8) | endpoint;
+}
+
+static inline uint16_t RecentRemoteHash(const uint32_t key) {
+  // Knuth's multiplicative hashing
+  uint32_t hash = key * 2654435761UL;
+
+  return (uint16_t)((hash ^ (hash >> 16)) & RECENT_SLOT_MASK);
+}
+
+static inline void RecentRemotesInit(RecentRemotes_t *recent) {
+  // all ones, RECENT_SLOT_EMPTY whatever the index width
+  MEMSET(recent->slots, 0xFF, sizeof(recent->slots));
+  recent->oldest = 0;
+  recent->count = 0;
+}
+
+static uint16_t RecentRemotesFind(const RecentRemotes_t *recent,
+                                  const uint32_t key) {
+  uint16_t slot = RecentRemoteHash(key);
+
+  while (recent->slots[slot] != RECENT_SLOT_EMPTY) {
+    if (recent->keys[recent->slots[slot]] == key) {
+      return slot;
+    }
+    slot = (slot + 1) & RECENT_SLOT_MASK;
+  }
+
+  return RECENT_SLOTS;
+}
+
+static void RecentRemotesAdd(RecentRemotes_t *recent, const uint32_t key) {
+  if (recent->count == RECENT_REMOTES) {
+    // forget the oldest remote
+    uint16_t slot = RecentRemotesFind(recent, recent->keys[recent->oldest]);
+    if (slot != RECENT_SLOTS) {
+      RecentRemotesRemoveSlot(recent, slot);
+    }
+    recent->oldest = (recent->oldest + 1) % RECENT_REMOTES;
+    --recent->count;
+  }
+
+  QueueIndex_t pos = (recent->oldest + recent->count) % RECENT_REMOTES;
+  uint16_t slot = RecentRemoteHash(key);
+
+  while (recent->slots[slot] != RECENT_SLOT_EMPTY) {
+    slot = (slot + 1) & RECENT_SLOT_MASK;
+  }
+
+  recent->keys[pos] = key;
+  recent->slots[slot] = pos;
+  ++recent->count;
+}
+
+static void RecentRemotesRemoveSlot(RecentRemotes_t *recent, uint16_t slot) {
+  uint16_t next = (slot + 1) & RECENT_SLOT_MASK;
+
+  // shift back the following entries of the probe sequence, so lookups
+  // do not stop at the freed slot
+  while (recent->slots[next] != RECENT_SLOT_EMPTY) {
+    uint16_t home = RecentRemoteHash(recent->keys[recent->slots[next]]);
+
+    if (((next - home) & RECENT_SLOT_MASK) >=
+        ((next - slot) & RECENT_SLOT_MASK)) {
+      recent->slots[slot] = recent->slots[next];
+      slot = next;
+    }
+    next = (next + 1) & RECENT_SLOT_MASK;
+  }
+
+  recent->slots[slot] = RECENT_SLOT_EMPTY;
 }
 
 static inline void InitQueueInternalData(MatchDescriptorQueue_t *queue) {
-  RingBufferInit(&queue->internal_data);
+  RingBufferInit(&queue->internal_data, queue->data, QUEUE_SLOTS, QUEUE_SIZE);
+}
+
+/// Endpoint and generation the producer reads, ordered as the indices
+static inline uint8_t LoadByte(const uint8_t *value) {
+#if defined(__GNUC__)
+  return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+#else
+  return *(const volatile uint8_t *)value;
+#endif
 }
 
-static inline bool QueueIsFull(MatchDescriptorQueue_t *queue) {
-  return RingBufferIsFull(&queue->internal_data);
+static inline void StoreByte(uint8_t *value, const uint8_t byte) {
+#if defined(__GNUC__)
+  __atomic_store_n(value, byte, __ATOMIC_RELEASE);
+#else
+  *(volatile uint8_t *)value = byte;
+#endif
+}
+
+static inline void SyncRecentRemotes(MatchDescriptorQueue_t *queue) {
+  // producer side, the consumer only moves the generation on
+  const uint8_t generation = LoadByte(&queue->generation);
+
+  if (queue->recent_remotes.generation != generation) {
+    RecentRemotesInit(&queue->recent_remotes);
+    queue->recent_remotes.generation = generation;
+  }
 }
 
 // Public interface implementation
-void InitQueue(void) { InitQueueInternalData(&devices_queue); }
+void InitQueue(MatchDescriptorQueue_t *queue) {
+  InitQueueInternalData(queue);
+  RecentRemotesInit(&queue->recent_remotes);
+  queue->recent_remotes.generation = 0;
+  StoreByte(&queue->generation, 0);
+  StoreByte(&queue->endpoint, 0);
+}
+
+void OpenQueue(MatchDescriptorQueue_t *queue, const uint8_t endpoint) {
+  if (queue->internal_data.buffer == NULL) {
+    // first use, the producer has never seen the queue open
+    InitQueue(queue);
+  } else {
+    // drop the leftovers, the tail is the producer's to move
+    StoreIndex(&queue->internal_data.head,
+               LoadIndex(&queue->internal_data.tail));
+  }
+
+  // the generation is published before the endpoint, so the producer
+  // taking the endpoint starts its recent remotes over
+  StoreByte(&queue->generation, (uint8_t)(queue->generation + 1));
+  StoreByte(&queue->endpoint, endpoint);
+}
+
+void CloseQueue(MatchDescriptorQueue_t *queue) {
+  StoreByte(&queue->endpoint, 0);
+}
+
+bool IsQueueOpenFor(const MatchDescriptorQueue_t *queue,
+                    const uint8_t endpoint) {
+  return endpoint != 0 && LoadByte(&queue->endpoint) == endpoint;
+}
+
+bool AddInDeviceDescriptor(MatchDescriptorQueue_t *queue,
+                           const EmberNodeId short_id, const uint8_t endpoint) {
+  SyncRecentRemotes(queue);
+
+  MatchDescriptorReq_t *in_conn = RingBufferReserve(&queue->internal_data);
+  if (in_conn == NULL) {
+    // queue is full
+    return false;
+  }
 
-bool AddInDeviceDescriptor(const EmberNodeId short_id, const uint8_t endpoint) {
-  if (!QueueIsFull(&devices_queue)) {
-    MatchDescriptorReq_t in_conn = {.source = short_id, .source_ep = endpoint};
+  // the slot keeps a processed remote's leftovers, only the header is
+  // set here (see MatchDescriptorReq_t)
+  in_conn->source = short_id;
+  in_conn->source_ep = endpoint;
+  in_conn->stage = SC_REMOTE_NEW;
+  in_conn->lookups = 0;
+  in_conn->reporting_pending = 0;
+  in_conn->clusters.count = 0;
+  in_conn->sm.transition.next_state = SC_EZ_DISCOVER;
+  in_conn->sm.transition.next_event = SC_EZEV_CHECK_CLUSTERS;
+  in_conn->sm.time_to_execute = 0;
+  in_conn->sm.scheduled = false;
+  RingBufferPush(&queue->internal_data);
 
-    uint8_t status = RingBufferPush(&devices_queue.internal_data, &in_conn);
-    return (status != RING_BUFFER_ERROR) ? true : false;
+  RecentRemotesAdd(&queue->recent_remotes,
+                   RecentRemoteKey(short_id, endpoint));
+  return true;
+}
+
+bool IsInDeviceKnown(const MatchDescriptorQueue_t *queue,
+                     const EmberNodeId short_id, const uint8_t endpoint) {
+  if (queue->recent_remotes.count == 0 ||
+      queue->recent_remotes.generation != LoadByte(&queue->generation)) {
+    // nothing added since the queue was opened
+    return false;
   }
 
-  return false;
+  return RecentRemotesFind(&queue->recent_remotes,
+                           RecentRemoteKey(short_id, endpoint)) !=
+         RECENT_SLOTS;
+}
+
+MatchDescriptorReq_t *GetTopInDeviceDescriptor(MatchDescriptorQueue_t *queue) {
+  return (MatchDescriptorReq_t *)RingBufferGet(&queue->internal_data);
 }
 
-MatchDescriptorReq_t *GetTopInDeviceDescriptor(void) {
-  return (MatchDescriptorReq_t *)RingBufferGet(&devices_queue.internal_data);
+MatchDescriptorReq_t *GetInDeviceDescriptor(MatchDescriptorQueue_t *queue,
+                                            const QueueIndex_t pos) {
+  return (MatchDescriptorReq_t *)RingBufferGetAt(&queue->internal_data, pos);
 }
 
-void PopInDeviceDescriptor(void) {
-  RingBufferPopFront(&devices_queue.internal_data);
+void PopInDeviceDescriptor(MatchDescriptorQueue_t *queue) {
+  RingBufferPopFront(&queue->internal_data);
 }
 
-uint8_t GetQueueSize(void) {
-  return RingBufferSize(&devices_queue.internal_data);
+QueueIndex_t GetQueueSize(const MatchDescriptorQueue_t *queue) {
+  return RingBufferSize(&queue->internal_data);
 }
@@ -4,16 +4,42 @@
 #include "app/framework/include/af.h"
 #include "simple-commissioning-td.h"
 
-/// Initialize queue
-void InitQueue(void);
+/// The queue is single-producer/single-consumer: IsQueueOpenFor,
+/// AddInDeviceDescriptor and IsInDeviceKnown are the producer's, the other
+/// calls the consumer's. The two might run in different contexts (threads
+/// on the host). The producer touches the descriptor it adds, the ring's
+/// tail and the recent remotes, which the consumer never reads but starts
+/// over by opening the queue again. Only the consumer changes the stage of
+/// a remote added as SC_REMOTE_NEW
+
+/// Initialize @queue closed, neither the producer nor the consumer may run
+void InitQueue(MatchDescriptorQueue_t *queue);
+/// Drop the remotes left in @queue and let it take Identify Query responses
+/// to the local @endpoint, the producer forgets the recent remotes before
+/// it adds the next one
+void OpenQueue(MatchDescriptorQueue_t *queue, const uint8_t endpoint);
+/// Stop @queue taking responses, a response being added right now still
+/// might end up queued
+void CloseQueue(MatchDescriptorQueue_t *queue);
+/// Whether @queue takes Identify Query responses to the local @endpoint
+bool IsQueueOpenFor(const MatchDescriptorQueue_t *queue,
+                    const uint8_t endpoint);
 /// Function for adding initial info about a remote device
 /// It is necessary to pass only remote device's short ID and endpoint
-bool AddInDeviceDescriptor(const EmberNodeId short_id, const uint8_t endpoint);
+bool AddInDeviceDescriptor(MatchDescriptorQueue_t *queue,
+                           const EmberNodeId short_id, const uint8_t endpoint);
+/// Whether the remote device is in @queue or was processed recently
+/// (since the queue was opened)
+bool IsInDeviceKnown(const MatchDescriptorQueue_t *queue,
+                     const EmberNodeId short_id, const uint8_t endpoint);
 /// Function for getting the top remote device's descriptor
-MatchDescriptorReq_t *GetTopInDeviceDescriptor(void);
+MatchDescriptorReq_t *GetTopInDeviceDescriptor(MatchDescriptorQueue_t *queue);
+/// Function for getting the remote device's descriptor at @pos from the top
+MatchDescriptorReq_t *GetInDeviceDescriptor(MatchDescriptorQueue_t *queue,
+                                            const QueueIndex_t pos);
 /// Delete the top descriptor
-void PopInDeviceDescriptor(void);
+void PopInDeviceDescriptor(MatchDescriptorQueue_t *queue);
 /// Get queue size
-uint8_t GetQueueSize(void);
+QueueIndex_t GetQueueSize(const MatchDescriptorQueue_t *queue);
 
 #endif  // SIMPLE_COMMISSIONING_INITIATOR_BUFFER_H
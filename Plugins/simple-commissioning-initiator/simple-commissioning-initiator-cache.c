@@ -0,0 +1,364 @@
+// *******************************************************************
+// * simple-commissioning-initiator-cache.c
+// *
+// * Remotes' simple descriptors kept in tokens, so re-commissioning
+// * a known remote needs no ZDO requests at all. Keys and LRU order
+// * are mirrored in RAM, a token is read only on a hit or to be
+// * compared and written only when a descriptor or its remote's
+// * identity changes
+// *
+// *******************************************************************
+
+#include "simple-commissioning-initiator-cache.h"
+
+#if DESCRIPTOR_CACHE_SIZE > 0
+
+/// Tokens are compared and sized by their fields, with no padding
+typedef char DescriptorTokenIsPacked[
+    (sizeof(tokTypeSimpleCommissioningDescriptor) ==
+     SIMPLE_COMMISSIONING_DESCRIPTOR_TOKEN_SIZE) ? 1 : -1];
+
+/*! \typedef struct DescriptorCacheKey
+    \brief Cached descriptor's identity
+*/
+typedef struct DescriptorCacheKey {
+  /// Remote's EUI64
+  EmberEUI64 eui64;
+  /// Remote's short ID, EMBER_NULL_NODE_ID if it is not trusted anymore
+  EmberNodeId node_id;
+  /// Remote's endpoint
+  uint8_t endpoint;
+  /// SIMPLE_COMMISSIONING_DESCRIPTOR_* flags
+  uint8_t flags;
+  /// Value of the cache clock the entry was last used at
+  uint32_t last_used;
+} DescriptorCacheKey_t;
+
+/*! \typedef struct DescriptorCache
+    \brief RAM part of the descriptors cache
+*/
+typedef struct DescriptorCache {
+  /// Keys of the SIMPLE_COMMISSIONING_DESCRIPTORS tokens
+  DescriptorCacheKey_t keys[DESCRIPTOR_CACHE_SIZE];
+  /// Ticks on every use of an entry. LRU order is not stored in tokens,
+  /// after a reboot entries are evicted in the token order first
+  uint32_t clock;
+} DescriptorCache_t;
+
+static DescriptorCache_t descriptor_cache;
+
+// Cache private interface
+static inline bool IsEntryUsable(const DescriptorCacheKey_t *const key);
+static inline void TouchEntry(const uint8_t index);
+static uint8_t FindEntry(const EmberNodeId node_id, const uint8_t endpoint);
+static uint8_t FindVictimEntry(void);
+static void LoadEntryKey(const uint8_t index,
+                         const tokTypeSimpleCommissioningDescriptor *const
+                             descriptor);
+static void WriteEntry(const uint8_t index,
+                       tokTypeSimpleCommissioningDescriptor *descriptor);
+static void WriteEntryNodeId(const uint8_t index, const EmberNodeId node_id,
+                             const uint8_t *eui64);
+static void EvictEntry(const uint8_t index);
+
+static inline bool IsEntryUsable(const DescriptorCacheKey_t *const key) {
+  const uint8_t usable = SIMPLE_COMMISSIONING_DESCRIPTOR_VALID |
+                         SIMPLE_COMMISSIONING_DESCRIPTOR_EUI64_KNOWN;
+
+  return (key->flags & usable) == usable;
+}
+
+static inline void TouchEntry(const uint8_t index) {
+  descriptor_cache.keys[index].last_used = ++descriptor_cache.clock;
+}
+
+static uint8_t FindEntry(const EmberNodeId node_id, const uint8_t endpoint) {
+  for (uint8_t i = 0; i < DESCRIPTOR_CACHE_SIZE; ++i) {
+    const DescriptorCacheKey_t *key = &descriptor_cache.keys[i];
+
+    if ((key->flags & SIMPLE_COMMISSIONING_DESCRIPTOR_VALID) &&
+        key->node_id == node_id && key->endpoint == endpoint) {
+      return i;
+    }
+  }
+
+  return DESCRIPTOR_NOT_CACHED;
+}
+
+static uint8_t FindVictimEntry(void) {
+  uint8_t victim = 0;
+
+  for (uint8_t i = 0; i < DESCRIPTOR_CACHE_SIZE; ++i) {
+    const DescriptorCacheKey_t *key = &descriptor_cache.keys[i];
+
+    if (!(key->flags & SIMPLE_COMMISSIONING_DESCRIPTOR_VALID)) {
+      return i;
+    }
+    if (key->last_used < descriptor_cache.keys[victim].last_used) {
+      victim = i;
+    }
+  }
+
+  return victim;
+}
+
+static void LoadEntryKey(const uint8_t index,
+                         const tokTypeSimpleCommissioningDescriptor *const
+                             descriptor) {
+  DescriptorCacheKey_t *key = &descriptor_cache.keys[index];
+
+  MEMCOPY(key->eui64, descriptor->eui64, EUI64_SIZE);
+  key->node_id = descriptor->node_id;
+  key->endpoint = descriptor->endpoint;
+  key->flags = descriptor->flags;
+}
+
+static void WriteEntry(const uint8_t index,
+                       tokTypeSimpleCommissioningDescriptor *descriptor) {
+  tokTypeSimpleCommissioningDescriptor stored;
+
+  // a remote commissioned again mostly has the same descriptor, reading
+  // the token spares the flash a write
+  halCommonGetIndexedToken(&stored, TOKEN_SIMPLE_COMMISSIONING_DESCRIPTORS,
+                           index);
+  if (MEMCOMPARE(&stored, descriptor, sizeof(stored)) != 0) {
+    halCommonSetIndexedToken(TOKEN_SIMPLE_COMMISSIONING_DESCRIPTORS, index,
+                             descriptor);
+  }
+  LoadEntryKey(index, descriptor);
+}
+
+static void WriteEntryNodeId(const uint8_t index, const EmberNodeId node_id,
+                             const uint8_t *eui64) {
+  tokTypeSimpleCommissioningDescriptor descriptor;
+
+  halCommonGetIndexedToken(&descriptor, TOKEN_SIMPLE_COMMISSIONING_DESCRIPTORS,
+                           index);
+  descriptor.node_id = node_id;
+  if (eui64 != NULL) {
+    MEMCOPY(descriptor.eui64, eui64, EUI64_SIZE);
+    descriptor.flags |= SIMPLE_COMMISSIONING_DESCRIPTOR_EUI64_KNOWN;
+  }
+  halCommonSetIndexedToken(TOKEN_SIMPLE_COMMISSIONING_DESCRIPTORS, index,
+                           &descriptor);
+  LoadEntryKey(index, &descriptor);
+}
+
+static void EvictEntry(const uint8_t index) {
+  tokTypeSimpleCommissioningDescriptor descriptor = {0};
+
+  if (descriptor_cache.keys[index].flags != 0) {
+    halCommonSetIndexedToken(TOKEN_SIMPLE_COMMISSIONING_DESCRIPTORS, index,
+                             &descriptor);
+  }
+  MEMSET(&descriptor_cache.keys[index], 0,
+         sizeof(descriptor_cache.keys[index]));
+}
+
+// Public interface implementation
+void InitDescriptorCache(void) {
+  tokTypeSimpleCommissioningDescriptor descriptor;
+
+  for (uint8_t i = 0; i < DESCRIPTOR_CACHE_SIZE; ++i) {
+    DescriptorCacheKey_t *key = &descriptor_cache.keys[i];
+
+    halCommonGetIndexedToken(&descriptor,
+                             TOKEN_SIMPLE_COMMISSIONING_DESCRIPTORS, i);
+    // keep the LRU order of entries that did not change since the last
+    // session
+    if (key->flags != descriptor.flags || key->node_id != descriptor.node_id ||
+        key->endpoint != descriptor.endpoint ||
+        MEMCOMPARE(key->eui64, descriptor.eui64, EUI64_SIZE) != 0) {
+      key->last_used = 0;
+    }
+    LoadEntryKey(i, &descriptor);
+  }
+}
+
+uint8_t FindCachedDescriptor(const EmberEUI64 eui64, const uint8_t endpoint) {
+  for (uint8_t i = 0; i < DESCRIPTOR_CACHE_SIZE; ++i) {
+    const DescriptorCacheKey_t *key = &descriptor_cache.keys[i];
+
+    if (IsEntryUsable(key) && key->endpoint == endpoint &&
+        MEMCOMPARE(key->eui64, eui64, EUI64_SIZE) == 0) {
+      return i;
+    }
+  }
+
+  return DESCRIPTOR_NOT_CACHED;
+}
+
+uint8_t FindCachedDescriptorByNodeId(const EmberNodeId node_id,
+                                     const uint8_t endpoint) {
+  uint8_t index = FindEntry(node_id, endpoint);
+
+  if (index == DESCRIPTOR_NOT_CACHED ||
+      !IsEntryUsable(&descriptor_cache.keys[index])) {
+    return DESCRIPTOR_NOT_CACHED;
+  }
+
+  return index;
+}
+
+void GetCachedDescriptor(const uint8_t index,
+                         tokTypeSimpleCommissioningDescriptor *descriptor) {
+  halCommonGetIndexedToken(descriptor, TOKEN_SIMPLE_COMMISSIONING_DESCRIPTORS,
+                           index);
+  TouchEntry(index);
+}
+
+void CacheDescriptor(const EmberNodeId node_id, const uint8_t endpoint,
+                     const uint8_t *eui64,
+                     const EmberAfClusterList *const clusters) {
+  tokTypeSimpleCommissioningDescriptor descriptor = {0};
+
+  if (clusters->inClusterCount + clusters->outClusterCount >
+      SIMPLE_COMMISSIONING_DESCRIPTOR_CLUSTERS) {
+    // a cut descriptor would hide clusters from later sessions
+    return;
+  }
+
+  // reuse the remote's old entry, then the entry of whatever remote had
+  // that short ID before
+  uint8_t index = (eui64 != NULL) ? FindCachedDescriptor(eui64, endpoint)
+                                  : DESCRIPTOR_NOT_CACHED;
+  if (index == DESCRIPTOR_NOT_CACHED) {
+    index = FindEntry(node_id, endpoint);
+    // the short ID is taken for the entry's remote until its EUI64 comes,
+    // ValidateCachedDescriptors drops the entry's EUI64 if it is not
+    if (eui64 == NULL && index != DESCRIPTOR_NOT_CACHED &&
+        IsEntryUsable(&descriptor_cache.keys[index])) {
+      eui64 = descriptor_cache.keys[index].eui64;
+    }
+  }
+  if (index == DESCRIPTOR_NOT_CACHED) {
+    index = FindVictimEntry();
+  }
+
+  descriptor.node_id = node_id;
+  descriptor.endpoint = endpoint;
+  descriptor.flags = SIMPLE_COMMISSIONING_DESCRIPTOR_VALID;
+  descriptor.profile_id = clusters->profileId;
+  descriptor.device_id = clusters->deviceId;
+  if (eui64 != NULL) {
+    MEMCOPY(descriptor.eui64, eui64, EUI64_SIZE);
+    descriptor.flags |= SIMPLE_COMMISSIONING_DESCRIPTOR_EUI64_KNOWN;
+  }
+  descriptor.in_count = (uint8_t)clusters->inClusterCount;
+  descriptor.out_count = (uint8_t)clusters->outClusterCount;
+  MEMCOPY(descriptor.clusters, clusters->inClusterList,
+          clusters->inClusterCount * sizeof(uint16_t));
+  MEMCOPY(descriptor.clusters + clusters->inClusterCount,
+          clusters->outClusterList,
+          clusters->outClusterCount * sizeof(uint16_t));
+
+  WriteEntry(index, &descriptor);
+  TouchEntry(index);
+
+  // entries of the remote that had the short ID before are not served
+  // by it anymore, those without an EUI64 are not served at all
+  for (uint8_t i = 0; i < DESCRIPTOR_CACHE_SIZE; ++i) {
+    const DescriptorCacheKey_t *key = &descriptor_cache.keys[i];
+
+    if (i == index || !(key->flags & SIMPLE_COMMISSIONING_DESCRIPTOR_VALID) ||
+        key->node_id != node_id || key->endpoint != endpoint) {
+      continue;
+    }
+    if (key->flags & SIMPLE_COMMISSIONING_DESCRIPTOR_EUI64_KNOWN) {
+      WriteEntryNodeId(i, EMBER_NULL_NODE_ID, NULL);
+    } else {
+      EvictEntry(i);
+    }
+  }
+}
+
+void ValidateCachedDescriptors(const EmberNodeId node_id,
+                               const EmberEUI64 eui64) {
+  // entries cached before the remote's EUI64 came are its newest ones
+  for (uint8_t i = 0; i < DESCRIPTOR_CACHE_SIZE; ++i) {
+    const DescriptorCacheKey_t *key = &descriptor_cache.keys[i];
+
+    if ((key->flags & SIMPLE_COMMISSIONING_DESCRIPTOR_VALID) &&
+        !(key->flags & SIMPLE_COMMISSIONING_DESCRIPTOR_EUI64_KNOWN) &&
+        key->node_id == node_id) {
+      WriteEntryNodeId(i, node_id, eui64);
+    }
+  }
+
+  for (uint8_t i = 0; i < DESCRIPTOR_CACHE_SIZE; ++i) {
+    const DescriptorCacheKey_t *key = &descriptor_cache.keys[i];
+
+    if (!IsEntryUsable(key)) {
+      continue;
+    }
+
+    bool same_node = key->node_id == node_id;
+    bool same_eui64 = MEMCOMPARE(key->eui64, eui64, EUI64_SIZE) == 0;
+
+    if (same_node && !same_eui64) {
+      // the short ID belongs to another remote now
+      WriteEntryNodeId(i, EMBER_NULL_NODE_ID, NULL);
+    } else if (!same_node && same_eui64) {
+      uint8_t newer = FindEntry(node_id, key->endpoint);
+
+      if (newer != DESCRIPTOR_NOT_CACHED &&
+          IsEntryUsable(&descriptor_cache.keys[newer]) &&
+          MEMCOMPARE(descriptor_cache.keys[newer].eui64, eui64, EUI64_SIZE) ==
+              0) {
+        // the remote has rejoined and its endpoint is cached again
+        EvictEntry(i);
+      } else {
+        // the remote has rejoined with a new short ID
+        WriteEntryNodeId(i, node_id, NULL);
+      }
+    }
+  }
+}
+
+void ClearDescriptorCache(void) {
+  for (uint8_t i = 0; i < DESCRIPTOR_CACHE_SIZE; ++i) {
+    EvictEntry(i);
+  }
+}
+
+#else  // DESCRIPTOR_CACHE_SIZE > 0
+
+void InitDescriptorCache(void) {}
+
+uint8_t FindCachedDescriptor(const EmberEUI64 eui64, const uint8_t endpoint) {
+  (void)eui64;
+  (void)endpoint;
+  return DESCRIPTOR_NOT_CACHED;
+}
+
+uint8_t FindCachedDescriptorByNodeId(const EmberNodeId node_id,
+                                     const uint8_t endpoint) {
+  (void)node_id;
+  (void)endpoint;
+  return DESCRIPTOR_NOT_CACHED;
+}
+
+void GetCachedDescriptor(const uint8_t index,
+                         tokTypeSimpleCommissioningDescriptor *descriptor) {
+  (void)index;
+  MEMSET(descriptor, 0, sizeof(*descriptor));
+}
+
+void CacheDescriptor(const EmberNodeId node_id, const uint8_t endpoint,
+                     const uint8_t *eui64,
+                     const EmberAfClusterList *const clusters) {
+  (void)node_id;
+  (void)endpoint;
+  (void)eui64;
+  (void)clusters;
+}
+
+void ValidateCachedDescriptors(const EmberNodeId node_id,
+                               const EmberEUI64 eui64) {
+  (void)node_id;
+  (void)eui64;
+}
+
+void ClearDescriptorCache(void) {}
+
+#endif  // DESCRIPTOR_CACHE_SIZE > 0
@@ -0,0 +1,41 @@
+#ifndef SIMPLE_COMMISSIONING_INITIATOR_CACHE_H
+#define SIMPLE_COMMISSIONING_INITIATOR_CACHE_H
+
+#include "app/framework/include/af.h"
+#include "simple-commissioning-td.h"
+
+/// Returned by FindCachedDescriptor*() for a descriptor that is not cached
+#define DESCRIPTOR_NOT_CACHED 0xFF
+
+/// Functions for working with the remotes' simple descriptors cache.
+/// Descriptors live in the SIMPLE_COMMISSIONING_DESCRIPTORS tokens, keys
+/// and LRU order are kept in RAM. With DESCRIPTOR_CACHE_SIZE 0 nothing
+/// is ever cached
+/// Read the cache keys from tokens, called on every session start
+void InitDescriptorCache(void);
+/// Cache entry of @endpoint on the remote @eui64 or DESCRIPTOR_NOT_CACHED
+uint8_t FindCachedDescriptor(const EmberEUI64 eui64, const uint8_t endpoint);
+/// Cache entry of @endpoint on the remote that had the short ID @node_id
+/// when cached, or DESCRIPTOR_NOT_CACHED. Only entries with a known EUI64
+/// are returned
+uint8_t FindCachedDescriptorByNodeId(const EmberNodeId node_id,
+                                     const uint8_t endpoint);
+/// Read the cache entry @index and mark it as recently used
+void GetCachedDescriptor(const uint8_t index,
+                         tokTypeSimpleCommissioningDescriptor *descriptor);
+/// Store the descriptor of @endpoint on @node_id, @eui64 might be NULL if
+/// it is not known yet. Replaces the remote's old entry or the least
+/// recently used one, the token is written only if it changes
+void CacheDescriptor(const EmberNodeId node_id, const uint8_t endpoint,
+                     const uint8_t *eui64,
+                     const EmberAfClusterList *const clusters);
+/// Check the cache against @node_id having @eui64: fill in the EUI64 of
+/// entries cached without it, move the remote's entries to its current
+/// short ID (evicting those cached again under it) and stop serving
+/// entries of other remotes by @node_id
+void ValidateCachedDescriptors(const EmberNodeId node_id,
+                               const EmberEUI64 eui64);
+/// Forget all cached descriptors
+void ClearDescriptorCache(void);
+
+#endif  // SIMPLE_COMMISSIONING_INITIATOR_CACHE_H
@@ -0,0 +1,167 @@
+// *******************************************************************
+// * simple-commissioning-initiator-clusters.c
+// *
+// * Local clusters lists preprocessing: client and server lists are
+// * deduplicated and hashed together once per session, so every
+// * discovered remote cluster costs a set lookup instead of a full list
+// * scan. Match results are kept per remote device model, identical
+// * remotes reuse them
+// *
+// *******************************************************************
+
+#include "simple-commissioning-initiator-clusters.h"
+
+#define CLUSTER_SLOT_EMPTY 0xFF
+
+// Matcher private interface
+static inline uint16_t HashCluster(const ClusterMatcher_t *matcher,
+                                   const uint16_t cluster_id);
+
+// Match results private interface
+static inline uint32_t HashWord(uint32_t hash, const uint16_t word);
+
+static inline uint16_t HashCluster(const ClusterMatcher_t *matcher,
+                                   const uint16_t cluster_id) {
+  // multiplicative hashing spreads clusters of the same ranges
+  // (0x00xx, 0x02xx, 0x04xx...) over the whole set
+  return (uint16_t)(((uint32_t)cluster_id * 40503UL) >> 4) & matcher->slot_mask;
+}
+
+void InitClusterMatcher(ClusterMatcher_t *matcher,
+                        const uint16_t *client_clusters,
+                        const uint8_t client_length,
+                        const uint16_t *server_clusters,
+                        const uint8_t server_length) {
+  const uint16_t *role_clusters[2] = {client_clusters, server_clusters};
+  const uint8_t role_lengths[2] = {client_length, server_length};
+  // the caller checks the lists fit LOCAL_CLUSTERS_LIST_LEN together
+  uint16_t length = (uint16_t)client_length + server_length;
+
+  matcher->present_roles = ((client_length != 0) ? SC_ROLE_CLIENT : 0) |
+                           ((server_length != 0) ? SC_ROLE_SERVER : 0);
+  matcher->len = 0;
+
+  // keep at least a half of the slots empty
+  matcher->slot_mask = 1;
+  while (matcher->slot_mask < 2 * length) {
+    matcher->slot_mask = (uint16_t)(matcher->slot_mask << 1 | 1);
+  }
+  MEMSET(matcher->slots, CLUSTER_SLOT_EMPTY, matcher->slot_mask + 1);
+
+  for (uint8_t list = 0; list < 2; ++list) {
+    const uint16_t *clusters = role_clusters[list];
+    const uint8_t role = (list == 0) ? SC_ROLE_CLIENT : SC_ROLE_SERVER;
+
+    for (uint8_t i = 0; i < role_lengths[list]; ++i) {
+      uint16_t slot = HashCluster(matcher, clusters[i]);
+
+      while (matcher->slots[slot] != CLUSTER_SLOT_EMPTY &&
+             matcher->unique_clusters[matcher->slots[slot]] != clusters[i]) {
+        slot = (slot + 1) & matcher->slot_mask;
+      }
+      if (matcher->slots[slot] != CLUSTER_SLOT_EMPTY) {
+        // duplicate, might be listed in the other role though
+        matcher->roles[matcher->slots[slot]] |= role;
+        continue;
+      }
+
+      matcher->unique_clusters[matcher->len] = clusters[i];
+      matcher->roles[matcher->len] = role;
+      matcher->slots[slot] = matcher->len;
+      ++matcher->len;
+    }
+  }
+}
+
+uint8_t FindLocalCluster(const ClusterMatcher_t *matcher,
+                         const uint16_t cluster_id, const uint8_t role) {
+  if (!(matcher->present_roles & role)) {
+    return CLUSTER_NOT_FOUND;
+  }
+
+  uint16_t slot = HashCluster(matcher, cluster_id);
+
+  while (matcher->slots[slot] != CLUSTER_SLOT_EMPTY) {
+    uint8_t pos = matcher->slots[slot];
+
+    if (matcher->unique_clusters[pos] == cluster_id) {
+      return (matcher->roles[pos] & role) ? pos : CLUSTER_NOT_FOUND;
+    }
+    slot = (slot + 1) & matcher->slot_mask;
+  }
+
+  return CLUSTER_NOT_FOUND;
+}
+
+uint16_t GetLocalCluster(const ClusterMatcher_t *matcher, const uint8_t pos) {
+  return matcher->unique_clusters[pos];
+}
+
+static inline uint32_t HashWord(uint32_t hash, const uint16_t word) {
+  // FNV-1a over both bytes
+  hash = (hash ^ LOW_BYTE(word)) * 16777619UL;
+  return (hash ^ HIGH_BYTE(word)) * 16777619UL;
+}
+
+void InitMatchResults(MatchResults_t *results) {
+  results->count = 0;
+  results->next = 0;
+}
+
+uint32_t GetDescriptorFingerprint(const EmberAfClusterList *const clusters) {
+  uint32_t hash = 2166136261UL;
+
+  hash = HashWord(hash, clusters->profileId);
+  hash = HashWord(hash, clusters->deviceId);
+  // counts keep clusters from moving between the lists unnoticed
+  hash = HashWord(hash, clusters->inClusterCount);
+  for (uint16_t i = 0; i < clusters->inClusterCount; ++i) {
+    hash = HashWord(hash, clusters->inClusterList[i]);
+  }
+  hash = HashWord(hash, clusters->outClusterCount);
+  for (uint16_t i = 0; i < clusters->outClusterCount; ++i) {
+    hash = HashWord(hash, clusters->outClusterList[i]);
+  }
+
+  return hash;
+}
+
+const MatchResult_t *FindMatchResult(const MatchResults_t *results,
+                                     const uint32_t fingerprint,
+                                     const EmberAfClusterList *const clusters) {
+  for (uint8_t i = 0; i < results->count; ++i) {
+    const MatchResult_t *result = &results->results[i];
+
+    // the lists are not stored, a fingerprint collision between equally
+    // long lists goes unnoticed (see MATCH_RESULTS_CACHE_SIZE)
+    if (result->fingerprint == fingerprint &&
+        result->profile_id == clusters->profileId &&
+        result->device_id == clusters->deviceId &&
+        result->in_count == clusters->inClusterCount &&
+        result->out_count == clusters->outClusterCount) {
+      return result;
+    }
+  }
+
+  return NULL;
+}
+
+void StoreMatchResult(MatchResults_t *results, const uint32_t fingerprint,
+                      const EmberAfClusterList *const clusters,
+                      const uint32_t *mask) {
+  MatchResult_t *result = NULL;
+
+  if (results->count < MATCH_RESULTS_CACHE_SIZE) {
+    result = &results->results[results->count++];
+  } else {
+    result = &results->results[results->next];
+    results->next = (uint8_t)((results->next + 1) % MATCH_RESULTS_CACHE_SIZE);
+  }
+
+  result->fingerprint = fingerprint;
+  result->profile_id = clusters->profileId;
+  result->device_id = clusters->deviceId;
+  result->in_count = (uint8_t)clusters->inClusterCount;
+  result->out_count = (uint8_t)clusters->outClusterCount;
+  MEMCOPY(result->clusters, mask, sizeof(result->clusters));
+}
@@ -0,0 +1,44 @@
+#ifndef SIMPLE_COMMISSIONING_INITIATOR_CLUSTERS_H
+#define SIMPLE_COMMISSIONING_INITIATOR_CLUSTERS_H
+
+#include "app/framework/include/af.h"
+#include "simple-commissioning-td.h"
+
+/// Returned by FindLocalCluster() for a cluster that is not in the list
+#define CLUSTER_NOT_FOUND 0xFF
+
+/// Functions for matching remote clusters against the local ones
+/// Prepare the local @client_clusters and @server_clusters lists, up to
+/// LOCAL_CLUSTERS_LIST_LEN together, for matching, called once per
+/// SimpleCommissioningStart
+void InitClusterMatcher(ClusterMatcher_t *matcher,
+                        const uint16_t *client_clusters,
+                        const uint8_t client_length,
+                        const uint16_t *server_clusters,
+                        const uint8_t server_length);
+/// Position of @cluster_id among the matcher's clusters if it is listed in
+/// the @role (one of LocalRole_t), CLUSTER_NOT_FOUND otherwise. Positions
+/// are below LOCAL_CLUSTERS_LIST_LEN, a cluster listed in both roles has
+/// one position
+uint8_t FindLocalCluster(const ClusterMatcher_t *matcher,
+                         const uint16_t cluster_id, const uint8_t role);
+/// Cluster ID at the matcher's position @pos
+uint16_t GetLocalCluster(const ClusterMatcher_t *matcher, const uint8_t pos);
+
+/// Functions for reusing match results of identical remote devices
+/// Forget all results, called once per SimpleCommissioningStart
+void InitMatchResults(MatchResults_t *results);
+/// Fingerprint of the simple descriptor @clusters
+uint32_t GetDescriptorFingerprint(const EmberAfClusterList *const clusters);
+/// Result stored for the descriptor @clusters with @fingerprint or NULL
+const MatchResult_t *FindMatchResult(const MatchResults_t *results,
+                                     const uint32_t fingerprint,
+                                     const EmberAfClusterList *const clusters);
+/// Store the supported clusters @mask (LOCAL_CLUSTERS_MASK_WORDS words,
+/// a bit per matcher's position) of the descriptor @clusters with
+/// @fingerprint, replacing the oldest result if there is no room
+void StoreMatchResult(MatchResults_t *results, const uint32_t fingerprint,
+                      const EmberAfClusterList *const clusters,
+                      const uint32_t *mask);
+
+#endif  // SIMPLE_COMMISSIONING_INITIATOR_CLUSTERS_H
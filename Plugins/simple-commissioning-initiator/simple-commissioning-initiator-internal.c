@@ -9,7 +9,13 @@
 // *******************************************************************
 
 #include "simple-commissioning-initiator-internal.h"
+#include "simple-commissioning-initiator-binding.h"
+#include "simple-commissioning-initiator-bits.h"
 #include "simple-commissioning-initiator-buffer.h"
+#include "simple-commissioning-initiator-cache.h"
+#include "simple-commissioning-initiator-clusters.h"
+#include "simple-commissioning-initiator-reporting.h"
+#include "simple-commissioning-initiator-rtt.h"
 #include "simple-commissioning-td.h"
 
 /*! Simple Commissioning Plugin event declaration */
@@ -33,16 +39,90 @@ static CommissioningState_t UnknownState(void);
 static CommissioningState_t FormJoinNetwork(void);
 static CommissioningState_t CheckQuery(void);
 static CommissioningState_t BindingDone(void);
-
-/// Functions for working with RemoteSkipClusters
-/// Initialize global struct RemoteSkipClusters variable
-static inline void InitRemoteSkipCluster(const uint16_t length);
-/// Skip the cluster @pos in the clusters list
-static inline void SkipRemoteCluster(const uint16_t pos);
-/// Return the skip mask
-static inline uint16_t GetRemoteSkipMask(void);
-/// Check if it is necessary to skip a cluster in @pos
-static inline bool IsSkipCluster(uint16_t pos);
+static CommissioningState_t ConfigureReporting(void);
+/// Finish processing of the current remote device
+static CommissioningState_t RemoteDone(void);
+/// Give up on the current remote device's EUI64
+static CommissioningState_t EUI64Timeout(void);
+
+/// Functions for running several state machine instances on the plugin's
+/// event
+/// Switch handlers to the @in_dev state machine instance
+static inline void PushDeviceContext(MatchDescriptorReq_t *in_dev);
+/// Switch handlers back to the session's state machine instance
+static inline void PopDeviceContext(void);
+/// Switch handlers to the @session and its state machine instance
+static inline void SetSessionContext(CommissioningSession_t *session);
+/// Remote device the current state machine instance belongs to
+static inline MatchDescriptorReq_t *GetCurrentDevice(void);
+/// Schedule the current instance's transition right away
+static inline void SetContextActive(void);
+/// Schedule the current instance's transition in @delay milliseconds
+static inline void SetContextDelayMS(const uint32_t delay);
+/// Schedule the current instance's transition in @delay quarterseconds
+static inline void SetContextDelayQS(const uint32_t delay);
+/// Run the current instance's transition
+static void RunStateMachine(void);
+/// Run the due transitions of the @session and its remotes, up to @budget
+/// of them. Returns the number of transitions run
+static uint8_t RunSessionStateMachines(CommissioningSession_t *session,
+                                       const uint8_t budget);
+/// Retire processed remotes and schedule the plugin's event for
+/// the earliest due transition of all sessions. Returns true if
+/// a transition is due right away
+static bool ScheduleStateMachine(void);
+/// Retire the @session's processed remotes and move @next_time to its
+/// earliest due transition (@scheduled tells whether @next_time is set)
+static void ScheduleSession(CommissioningSession_t *session,
+                            const uint32_t now, bool *scheduled,
+                            uint32_t *next_time);
+/// Take the remotes queued since the session's last run, moving the
+/// Identify Query responses window, and make the session due at @now
+/// to put them in flight
+static void CollectNewDevices(const uint32_t now);
+/// Put queued remotes in flight while the discovery window has room
+static void AdmitQueuedDevices(void);
+/// Search the stack's tables for the current remote's EUI64 (once per
+/// remote), returns true if the EUI64 is known
+static bool LookupLocalEUI64(void);
+/// Serve the current remote's descriptor from the descriptors cache (once
+/// per remote), returns true on a hit
+static bool LookupCachedDescriptor(void);
+/// Schedule another try of the current remote's discovery request the stack
+/// refused, false once the session spent SIMPLE_COMMISSIONING_DISCOVERY_RETRIES
+static bool RetryDiscovery(void);
+/// Find an in-flight remote device of a session on the current network
+/// waiting for a discovery response (@lookup is one of RemoteLookup_t
+/// *_PENDING flags) from the @endpoint of @source (SC_ANY_ENDPOINT if
+/// the response does not tell it), @session is set to the remote's session.
+/// Of several such remotes the one asked first is taken
+static MatchDescriptorReq_t *FindInFlightDevice(
+    const EmberNodeId source, const uint8_t endpoint, const uint8_t lookup,
+    CommissioningSession_t **session);
+/// When the remote's @lookup request of the @session was sent
+static inline uint32_t GetLookupSentMs(CommissioningSession_t *session,
+                                       const MatchDescriptorReq_t *in_dev,
+                                       const uint8_t lookup);
+/// Running session on the @endpoint, NULL if there is none
+static CommissioningSession_t *FindSession(const uint8_t endpoint);
+/// Remotes queue taking Identify Query responses to the @endpoint, NULL if
+/// there is none. The responses callback's, it reads nothing but the queues
+static MatchDescriptorQueue_t *FindIdentifyQueue(const uint8_t endpoint);
+
+/// Functions for working with the current remote's RemoteClusters
+/// Forget all clusters of the remote
+static inline void ClearRemoteClusters(void);
+/// Skip the cluster @bit
+static inline void SkipRemoteCluster(const uint16_t bit);
+/// Return the number of clusters that are not skipped
+static inline uint16_t CountRemoteClusters(void);
+/// Bit of the first not skipped cluster starting from @bit,
+/// REMOTE_CLUSTERS_MASK_BITS if there are no more such clusters
+static inline uint16_t NextRemoteCluster(uint16_t bit);
+/// Local endpoint descriptor (index) the cluster @bit is bound from
+static inline uint8_t GetRemoteClusterLocal(const uint16_t bit);
+/// Cluster ID of the cluster @bit
+static inline uint16_t GetRemoteClusterId(const uint16_t bit);
 
 /// Function for working with network attempts variable
 /// Get current attempt
@@ -51,53 +131,147 @@ static inline uint8_t GetNetworkTries(void);
 static inline void IncNetworkTries(void);
 /// Clear variable
 static inline void ClearNetworkTries(void);
+/// Whether a session other than the current one is running
+static bool IsAnotherSessionRunning(void);
 
 /// Functions for checking which clusters on the remote device we want to bind
 /// and checking if the binding already exists in the binding table
-/// Check whether our device support some incoming clusters for the passing
-/// list.
+/// Check whether the local endpoint descriptor @local supports some
+/// incoming clusters for the passing list in the @role and add them to
+/// the current remote's clusters. Returns false if some of them did not
+/// fit.
 /// Called during the SC_EZ_DISCOVER state when got a SIMPLE_DESCRIPTOR response
-static inline uint8_t CheckSupportedClusters(
+static inline bool CheckSupportedClusters(
+    const uint8_t local, const LocalRole_t role,
     const uint16_t *incoming_cl_list, const uint8_t incoming_cl_list_len);
+/// Add the local endpoint descriptor @local's cluster at the matcher's
+/// position @pos to the current remote's clusters, false if the remote
+/// has INCOMING_DEVICE_CLUSTERS_LIST_LEN clusters already. A cluster
+/// matched in both roles is added once
+static inline bool AddRemoteCluster(const uint8_t local, const uint8_t pos);
+/// Add the current remote's clusters matching the local endpoint
+/// descriptor @local from its descriptor @clusters
+static void MatchLocalEndpoint(const uint8_t local,
+                               const EmberAfClusterList *const clusters,
+                               const uint32_t fingerprint);
+/// Pick the current remote's clusters to bind from its descriptor
+/// @clusters for every local endpoint and schedule the matching check.
+/// Returns the next state
+static CommissioningState_t MatchDescriptorClusters(
+    const EmberAfClusterList *const clusters);
 
 /// Check whether our device already has some bindings in the binding table
 /// Called during the SC_EZ_MATCH state for checking whether we already have
 /// all necessary bindings or not
 static void MarkDuplicateMatches(const MatchDescriptorReq_t *const in_dev);
+/// Keep only the clusters just bound that the current remote should
+/// configure reporting for in its clusters mask. Returns whether there is any
+static bool PlanReporting(void);
+/// Send a Bind request for reports to the local endpoint and a Configure
+/// Reporting request for the remote's cluster @bit, false if nothing was
+/// sent
+static bool SendConfigureReporting(const MatchDescriptorReq_t *const in_dev,
+                                   const uint16_t bit);
+/// Await the Configure Reporting response for @cluster_id of the remote,
+/// the request was sent at @now
+static void AddReporting(MatchDescriptorReq_t *in_dev,
+                         const uint16_t cluster_id, const uint32_t now);
+/// Oldest Configure Reporting request of the remote in the @session
+/// awaiting its response for @cluster_id (SC_ANY_CLUSTER for any
+/// cluster), NULL if there is none
+static ReportingRecord_t *FindReporting(CommissioningSession_t *session,
+                                        const MatchDescriptorReq_t *in_dev,
+                                        const uint16_t cluster_id);
+/// Stop awaiting the Configure Reporting response of the @record and
+/// wake up the session's remotes waiting for the reporting window
+static void ReleaseReporting(ReportingRecord_t *record);
 
 /*! Callback for Service Discovery Request */
 static void ProcessServiceDiscovery(
     const EmberAfServiceDiscoveryResult *result);
 static void ProcessEUI64Discovery(const EmberAfServiceDiscoveryResult *result);
 
-/*! State Machine Table */
-static const SMTask_t sm_transition_table[] = {
-    {SC_EZ_STOP, SC_EZEV_IDLE, &StartCommissioning},
-    {SC_EZ_START, SC_EZEV_CHECK_NETWORK, &CheckNetwork},
-    {SC_EZ_START, SC_EZEV_BCAST_IDENT_QUERY, &BroadcastIdentifyQuery},
-    {SC_EZ_START, SC_EZEV_FORM_JOIN_NETWORK, &FormJoinNetwork},
-    {SC_EZ_START, SC_EZEV_NETWORK_FAILED, &StopCommissioning},
-    {SC_EZ_WAIT_IDENT_RESP, SC_EZEV_TIMEOUT, &StopCommissioning},
-    {SC_EZ_DISCOVER, SC_EZEV_CHECK_CLUSTERS, &CheckClusters},
-    {SC_EZ_DISCOVER, SC_EZEV_BAD_DISCOVER, &StopCommissioning},
-    {SC_EZ_MATCH, SC_EZEV_CHECK_CLUSTERS, &MatchingCheck},
-    {SC_EZ_MATCH, SC_EZEV_NOT_MATCHED, &StopCommissioning},
-    {SC_EZ_BIND, SC_EZEV_BIND, &SetBinding},
-    {SC_EZ_BIND, SC_EZEV_CHECK_QUEUE, &CheckQuery},
-    {SC_EZ_BIND, SC_EZEV_BINDING_DONE, &BindingDone},
-    {SC_EZ_BIND, SC_EZEV_QUEUE_EMPTY, &StopCommissioning},
-    {SC_EZ_UNKNOWN, SC_EZEV_UNKNOWN, &UnknownState}};
-
-#define TRANSIT_TABLE_SIZE() \
-  (sizeof(sm_transition_table) / sizeof(sm_transition_table[0]))
-
-/*! Global for storing next state machine transition
+/*! State Machine Table
+
+    Session: STOP -> START -> WAIT_IDENT_RESP -> BIND/CHECK_QUEUE
+    Remote:  DISCOVER -> MATCH -> BIND -> [REPORT ->] STOP (retired from
+             the queue)
+
+    X(state, event, handler) for every transition. Any other state and
+    event pair is handled by UnknownState
+*/
+#define SC_TRANSITIONS(X)                                                     \
+  X(SC_EZ_STOP, SC_EZEV_IDLE, StartCommissioning)                             \
+  X(SC_EZ_START, SC_EZEV_CHECK_NETWORK, CheckNetwork)                         \
+  X(SC_EZ_START, SC_EZEV_BCAST_IDENT_QUERY, BroadcastIdentifyQuery)           \
+  X(SC_EZ_START, SC_EZEV_FORM_JOIN_NETWORK, FormJoinNetwork)                  \
+  X(SC_EZ_START, SC_EZEV_NETWORK_FAILED, StopCommissioning)                   \
+  X(SC_EZ_WAIT_IDENT_RESP, SC_EZEV_TIMEOUT, StopCommissioning)                \
+  X(SC_EZ_DISCOVER, SC_EZEV_CHECK_CLUSTERS, CheckClusters)                    \
+  X(SC_EZ_DISCOVER, SC_EZEV_BAD_DISCOVER, RemoteDone)                         \
+  X(SC_EZ_MATCH, SC_EZEV_CHECK_CLUSTERS, MatchingCheck)                       \
+  X(SC_EZ_MATCH, SC_EZEV_NOT_MATCHED, RemoteDone)                             \
+  X(SC_EZ_MATCH, SC_EZEV_BAD_DISCOVER, RemoteDone)                            \
+  X(SC_EZ_BIND, SC_EZEV_BIND, SetBinding)                                     \
+  X(SC_EZ_BIND, SC_EZEV_AWAIT_EUI64, EUI64Timeout)                            \
+  X(SC_EZ_BIND, SC_EZEV_NOT_MATCHED, RemoteDone)                              \
+  X(SC_EZ_BIND, SC_EZEV_CHECK_QUEUE, CheckQuery)                              \
+  X(SC_EZ_BIND, SC_EZEV_BINDING_DONE, BindingDone)                            \
+  X(SC_EZ_BIND, SC_EZEV_QUEUE_EMPTY, StopCommissioning)                       \
+  X(SC_EZ_REPORT, SC_EZEV_CONFIGURE_REPORTING, ConfigureReporting)            \
+  X(SC_EZ_REPORT, SC_EZEV_REPORTING_DONE, RemoteDone)
+
+/*! Index of every transition in sm_handlers. A state and event pair listed
+    twice would leave one of its handlers unreachable, so it fails to
+    compile as a redefined enumerator
+*/
+#define SC_TRANSITION_INDEX(state, event, handler) state##__##event,
+enum { SC_TRANSITIONS(SC_TRANSITION_INDEX) SC_TRANSITIONS_COUNT };
+#undef SC_TRANSITION_INDEX
+
+/// Dispatch table entries are stored as uint8_t
+typedef char SMTransitionsFitDispatchTable[
+    (SC_TRANSITIONS_COUNT < 0xFF) ? 1 : -1];
+
+#define SC_TRANSITION_HANDLER(state, event, handler) &handler,
+static const SMHandler_t sm_handlers[SC_TRANSITIONS_COUNT + 1] = {
+    &UnknownState, SC_TRANSITIONS(SC_TRANSITION_HANDLER)};
+#undef SC_TRANSITION_HANDLER
+
+/*! Dense dispatch table: sm_handlers index (1-based) of the transition
+    for a state and an event, 0 (UnknownState) if there is none. A state
+    or an event out of the table's range fails to compile
+*/
+#define SC_TRANSITION_ENTRY(state, event, handler) \
+  [state][event] = state##__##event + 1,
+static const uint8_t
+    sm_dispatch_table[SC_EZ_STATES_COUNT][SC_EZEV_EVENTS_COUNT] = {
+        SC_TRANSITIONS(SC_TRANSITION_ENTRY)};
+#undef SC_TRANSITION_ENTRY
+
+/// SMNext_t keeps states and events in a byte each
+typedef char SMStatesAndEventsFitByte[
+    (SC_EZ_STATES_COUNT <= 0x100 && SC_EZEV_EVENTS_COUNT <= 0x100) ? 1 : -1];
+
+/// Every state machine instance takes a tick, a transition and a flag
+typedef char SMContextIsPacked[
+    (sizeof(SMContext_t) == 8) ? 1 : -1];
+
+/*! Global for storing the commissioning sessions
  */
-SMNext_t next_transition = {SC_EZ_STOP, SC_EZEV_IDLE};
+CommissioningSession_t commissioning_sessions[CONCURRENT_SESSIONS];
 
-/*! Global for storing device's attempts for forming or joining a network
+/*! Session handlers currently work with, the state machine instance of it
+    (the session's one or a remote device's one) and the remote device
+    that instance belongs to
  */
-static uint8_t network_access_tries = 0;
+static CommissioningSession_t *current_session = commissioning_sessions;
+static SMContext_t *current_sm = &commissioning_sessions[0].sm;
+static MatchDescriptorReq_t *current_dev = NULL;
+
+/*! Session the plugin's event handler serves first on its next run
+ */
+static uint8_t next_session = 0;
 
 /*! \define NETWORK_ACCESS_CONS_TRIES
  *
@@ -105,15 +279,6 @@ static uint8_t network_access_tries = 0;
  */
 #define NETWORK_ACCESS_CONS_TRIES 3
 
-/*! Global for storing incoming device's info (Short ID, EUI64, endpoint)
- */
-MatchDescriptorReq_t incoming_conn;
-
-/*! Global for storing bit mask of which cluster from a remote device must be
-    skipped
- */
-RemoteSkipClusters_t skip_mask;
-
 /*! \typedef SIMPLE_COMMISSIONING_PERMIT_JOIN_TIME
  *
  *  Define time period for which a device permits join for remotes (in second)
@@ -132,19 +297,20 @@ RemoteSkipClusters_t skip_mask;
  *
  *  Define time period that is a Identify Query Response await timeout
  *  (in milliseconds). If our devic don't get any response it will get timeout
- * event
+ * event. Follows round trip times measured on the session's network, but
+ * never closes before sleepy remotes polled for the broadcast
  */
 #define SIMPLE_COMMISSIONING_IDENTIFY_RESPONSE_WAIT_TIME() \
-  (2 * emberAfGetShortPollIntervalMsCallback() + 100)
+  GetBroadcastWaitTime(current_session->network_index)
 
 /*! \typedef SIMPLE_COMMISSIONING_EUI64_RESPONSE_WAIT_TIME
  *
- *  Define time period that is a Identify Query Response await timeout
+ *  Define time period that is a IEEE address response await timeout
  *  (in milliseconds). If our devic don't get any response it will get timeout
- * event
+ * event. Follows round trip times measured on the session's network
  */
 #define SIMPLE_COMMISSIONING_EUI64_RESPONSE_WAIT_TIME() \
-  (2 * emberAfGetShortPollIntervalMsCallback() + 100)
+  GetResponseWaitTime(current_session->network_index)
 
 /*! \typedef SIMPLE_COMMISSIONING_NETWORK_RETRY_DELAY
  *
@@ -154,68 +320,184 @@ RemoteSkipClusters_t skip_mask;
  */
 #define SIMPLE_COMMISSIONING_NETWORK_RETRY_DELAY 40
 
+/*! \typedef SIMPLE_COMMISSIONING_DISCOVERY_RETRY_DELAY
+ *
+ *  Define time period after which a remote device retries a service
+ *  discovery request the stack had no free state for (in milliseconds)
+ */
+#define SIMPLE_COMMISSIONING_DISCOVERY_RETRY_DELAY 100
+
+/*! \typedef SIMPLE_COMMISSIONING_DISCOVERY_RETRIES
+ *
+ *  Define how much service discovery requests of a session the stack might
+ *  refuse in a row before the remotes are given up, per remote in flight.
+ *  The retries take about 5 seconds, a busy stack accepts a request well
+ *  before as its states are freed within a discovery timeout
+ */
+#define SIMPLE_COMMISSIONING_DISCOVERY_RETRIES (50 * DISCOVERY_WINDOW)
+
+/*! \define SC_ANY_ENDPOINT
+
+    Endpoint of a response that does not tell which endpoint of the remote
+    it comes from (timeouts, IEEE address responses)
+*/
+#define SC_ANY_ENDPOINT 0xFF
+
+/*! \define SC_ANY_CLUSTER
+
+    Cluster ID matching the records of every cluster, not a valid
+    cluster ID itself
+*/
+#define SC_ANY_CLUSTER 0xFFFF
+
 /*! Helper inline function for getting next state */
 static inline CommissioningState_t GetNextState(void) {
-  return next_transition.next_state;
+  return current_sm->transition.next_state;
 }
 
 /*! Helper inline function for getting next event */
 static inline CommissioningEvent_t GetNextEvent(void) {
-  return next_transition.next_event;
+  return current_sm->transition.next_event;
 }
 
 /*! Helper inline function for setting next state */
 static inline void SetNextState(const CommissioningState_t cstate) {
-  next_transition.next_state = cstate;
+  current_sm->transition.next_state = cstate;
 }
 
 /*! Helper inline function for setting next event */
 static inline void SetNextEvent(const CommissioningEvent_t cevent) {
-  next_transition.next_event = cevent;
+  current_sm->transition.next_event = cevent;
+}
+
+static inline void PushDeviceContext(MatchDescriptorReq_t *in_dev) {
+  current_dev = in_dev;
+  current_sm = &in_dev->sm;
+}
+
+static inline void PopDeviceContext(void) {
+  current_dev = NULL;
+  current_sm = &current_session->sm;
+}
+
+static inline void SetSessionContext(CommissioningSession_t *session) {
+  current_session = session;
+  current_dev = NULL;
+  current_sm = &session->sm;
+}
+
+static inline MatchDescriptorReq_t *GetCurrentDevice(void) {
+  return current_dev;
+}
+
+static inline void SetContextActive(void) { SetContextDelayMS(0); }
+
+static inline void SetContextDelayMS(const uint32_t delay) {
+  current_sm->time_to_execute = halCommonGetInt32uMillisecondTick() + delay;
+  current_sm->scheduled = true;
+}
+
+static inline void SetContextDelayQS(const uint32_t delay) {
+  SetContextDelayMS(delay * 250);
+}
+
+/*! Helper inline function for checking whether a state machine instance
+    is idle (session stopped or remote device processed)
+*/
+static inline bool IsIdleTransition(const SMNext_t *transition) {
+  return transition->next_state == SC_EZ_STOP &&
+         transition->next_event == SC_EZEV_IDLE;
+}
+
+/*! Open the Identify Query responses window. Remotes the application
+    expects are waited for up to the window limit, otherwise no response
+    can tell yet whether anybody is going to answer, so the window is
+    the response wait window
+*/
+static inline void OpenIdentifyWindow(void) {
+  CommissioningSession_t *session = current_session;
+  uint32_t now = halCommonGetInt32uMillisecondTick();
+  uint32_t wait_time = SIMPLE_COMMISSIONING_IDENTIFY_RESPONSE_WAIT_TIME();
+
+  session->identify_window_limit =
+      now + ((wait_time > IDENTIFY_WINDOW_LIMIT) ? wait_time
+                                                 : IDENTIFY_WINDOW_LIMIT);
+  session->identify_window_end = (session->expected_remotes != 0)
+                                     ? session->identify_window_limit
+                                     : now + wait_time;
+  session->identified_remotes = 0;
+}
+
+/*! Move the Identify Query responses window's end after a new remote was
+    taken: close it once all expected remotes are there, or keep it open
+    for the quiet period (up to the window limit) if nothing is expected.
+    The quiet period only extends the window, remotes that answer fast
+    don't cut off the sleepy ones
+*/
+static inline void UpdateIdentifyWindow(void) {
+  CommissioningSession_t *session = current_session;
+  uint32_t now = halCommonGetInt32uMillisecondTick();
+
+  ++session->identified_remotes;
+  if (session->expected_remotes != 0) {
+    if (session->identified_remotes >= session->expected_remotes) {
+      session->identify_window_end = now;
+    }
+  } else if (IDENTIFY_QUIET_PERIOD > 0) {
+    uint32_t quiet_end =
+        ((int32_t)(session->identify_window_limit - now) >
+         IDENTIFY_QUIET_PERIOD)
+            ? now + IDENTIFY_QUIET_PERIOD
+            : session->identify_window_limit;
+
+    if ((int32_t)(quiet_end - session->identify_window_end) > 0) {
+      session->identify_window_end = quiet_end;
+    }
+  }
+}
+
+/*! Helper inline function for checking whether the @session is processing
+    the remotes queue or is waiting for the first response
+*/
+static inline bool IsSessionCollecting(
+    const CommissioningSession_t *session) {
+  const SMNext_t *transition = &session->sm.transition;
+
+  return transition->next_state == SC_EZ_WAIT_IDENT_RESP ||
+         (transition->next_state == SC_EZ_BIND &&
+          transition->next_event == SC_EZEV_CHECK_QUEUE);
+}
+
+/*! Helper inline function for checking whether a session is stopped and
+    has nothing scheduled or queued, so its slot might take a new session
+*/
+static inline bool IsSessionIdle(const CommissioningSession_t *session) {
+  return IsIdleTransition(&session->sm.transition) &&
+         !session->sm.scheduled && GetQueueSize(&session->queue) == 0;
 }
 
 /*! Helper inline function for setting an incoming connection info
-    during the Identify Query Response
+    during the Identify Query Response. Returns whether the remote is queued
 */
-static inline void SetInConnBaseInfo(const EmberNodeId short_id,
+static inline bool SetInConnBaseInfo(MatchDescriptorQueue_t *queue,
+                                     const EmberNodeId short_id,
                                      const uint8_t endpoint) {
   // try to add the new remote device descriptor to the queue
-  if (!AddInDeviceDescriptor(short_id, endpoint)) {
+  if (!AddInDeviceDescriptor(queue, short_id, endpoint)) {
     // queue is probably full
     emberAfDebugPrintln(
         "DEBUG: WARNING: incoming device response will be missed");
+    return false;
   }
-}
-
-/*! Helper inline function for setting an incoming connection device's
-    clusters list and length of that list
-*/
-static inline void SetInDevicesClustersInfo(const uint16_t *clusters_list,
-                                            const uint8_t clusters_list_len,
-                                            const uint8_t supported_clusters) {
-  MatchDescriptorReq_t *in_dev = GetTopInDeviceDescriptor();
-  assert(in_dev != NULL);
-  in_dev->source_cl_arr_len = supported_clusters;
-  uint8_t supported_cluster_idx = 0;
 
-  for (size_t i = 0; i < clusters_list_len; ++i) {
-    // if we want to bind to that cluster (appropriate bit in the cluster
-    // mask is 1), add it
-    if (!IsSkipCluster(i) &&
-        supported_cluster_idx < INCOMING_DEVICE_CLUSTERS_LIST_LEN) {
-      emberAfDebugPrintln("DEBUG: Supported cluster 0x%X%X",
-                          HIGH_BYTE(clusters_list[i]),
-                          LOW_BYTE(clusters_list[i]));
-      in_dev->source_cl_arr[supported_cluster_idx++] = clusters_list[i];
-    }
-  }
+  return true;
 }
 
 /*! Helper inline function for setting an incoming connection device's
     clusters list and length of that list
 */
 static inline void SetInConnEUI64Address(const EmberEUI64 in_eui64) {
-  MatchDescriptorReq_t *in_dev = GetTopInDeviceDescriptor();
+  MatchDescriptorReq_t *in_dev = GetCurrentDevice();
   assert(in_dev != NULL);
   MEMCOPY(in_dev->source_eui64, in_eui64, EUI64_SIZE);
 }
@@ -223,26 +505,70 @@ static inline void SetInConnEUI64Address(const EmberEUI64 in_eui64) {
 /*! State Machine function */
 void emberAfPluginSimpleCommissioningInitiatorStateMachineEventHandler(void) {
   emberEventControlSetInactive(StateMachineEvent);
+  emberAfDebugPrintln("DEBUG: State Machine");
+  const uint32_t started = halCommonGetInt32uMillisecondTick();
+  uint8_t steps = 0;
+  bool due = false;
+  // Run transitions made due by the previous ones right here instead of
+  // a trip through the stack's event loop, until the budget is spent
+  do {
+    // Sessions take turns, the one after the last served goes first, so
+    // a busy session can't spend the whole budget every time
+    for (uint8_t i = 0; i < CONCURRENT_SESSIONS && steps < RUN_STEPS_BUDGET;
+         ++i) {
+      uint8_t index = (next_session + i) % CONCURRENT_SESSIONS;
+      uint8_t session_steps =
+          RunSessionStateMachines(&commissioning_sessions[index],
+                                  RUN_STEPS_BUDGET - steps);
+
+      if (session_steps != 0) {
+        steps += session_steps;
+        next_session = (index + 1) % CONCURRENT_SESSIONS;
+      }
+    }
+    // transitions left due yield to the stack with the event set active
+    due = ScheduleStateMachine();
+  } while (due && steps < RUN_STEPS_BUDGET &&
+           (RUN_TIME_BUDGET == 0 ||
+            halCommonGetInt32uMillisecondTick() - started < RUN_TIME_BUDGET));
+}
+
+static uint8_t RunSessionStateMachines(CommissioningSession_t *session,
+                                       const uint8_t budget) {
+  const uint32_t now = halCommonGetInt32uMillisecondTick();
+  uint8_t steps = 0;
+
+  if (IsSessionIdle(session)) {
+    return 0;
+  }
+
+  SetSessionContext(session);
   // That might happened that ZigBee state machine changed current network
   // So, it is important to switch to the proper network before commissioning
   // state machine might start
-  EmberStatus status = emberAfPushNetworkIndex(dev_comm_session.network_index);
+  EmberStatus status =
+      emberAfPushNetworkIndex(session->network_index);
   if (status != EMBER_SUCCESS) {
     // TODO: Handle unavailability of switching network
   }
-  emberAfDebugPrintln("DEBUG: State Machine");
-  // Get state previously set by some handler
-  CommissioningState_t cur_state = GetNextState();
-  CommissioningEvent_t cur_event = GetNextEvent();
-  for (size_t i = 0; i < TRANSIT_TABLE_SIZE(); ++i) {
-    if ((cur_state == sm_transition_table[i].state ||
-         SC_EZ_UNKNOWN == sm_transition_table[i].state) &&
-        ((cur_event == sm_transition_table[i].event) ||
-         SC_EZEV_UNKNOWN == sm_transition_table[i].event)) {
-      // call handler which set the next_state on return and
-      // next_event inside itself
-      SetNextState((sm_transition_table[i].handler)());
-      break;
+  // Session goes first as it puts queued remotes in flight
+  CollectNewDevices(now);
+  if (session->sm.scheduled &&
+      (int32_t)(now - session->sm.time_to_execute) >= 0) {
+    RunStateMachine();
+    ++steps;
+  }
+  // Then every remote device which transition is due
+  for (QueueIndex_t pos = 0;
+       pos < GetQueueSize(&session->queue) && steps < budget; ++pos) {
+    MatchDescriptorReq_t *in_dev = GetInDeviceDescriptor(&session->queue, pos);
+
+    if (in_dev->stage == SC_REMOTE_IN_FLIGHT && in_dev->sm.scheduled &&
+        (int32_t)(now - in_dev->sm.time_to_execute) >= 0) {
+      PushDeviceContext(in_dev);
+      RunStateMachine();
+      PopDeviceContext();
+      ++steps;
     }
   }
 
@@ -250,6 +576,312 @@ void emberAfPluginSimpleCommissioningInitiatorStateMachineEventHandler(void) {
   status = emberAfPopNetworkIndex();
   // sanity check that network switched back properly
   EMBER_TEST_ASSERT(status == EMBER_SUCCESS);
+
+  return steps;
+}
+
+static void RunStateMachine(void) {
+  current_sm->scheduled = false;
+  // Get state previously set by some handler
+  CommissioningState_t cur_state = GetNextState();
+  CommissioningEvent_t cur_event = GetNextEvent();
+  uint8_t transition = 0;
+
+  if (cur_state < SC_EZ_STATES_COUNT && cur_event < SC_EZEV_EVENTS_COUNT) {
+    transition = sm_dispatch_table[cur_state][cur_event];
+  }
+  // call handler which set the next_state on return and
+  // next_event inside itself
+  SetNextState((sm_handlers[transition])());
+}
+
+static bool ScheduleStateMachine(void) {
+  const uint32_t now = halCommonGetInt32uMillisecondTick();
+  bool scheduled = false;
+  uint32_t next_time = now;
+
+  for (uint8_t i = 0; i < CONCURRENT_SESSIONS; ++i) {
+    ScheduleSession(&commissioning_sessions[i], now, &scheduled, &next_time);
+  }
+
+  if (!scheduled) {
+    emberEventControlSetInactive(StateMachineEvent);
+  } else if ((int32_t)(next_time - now) <= 0) {
+    emberEventControlSetActive(StateMachineEvent);
+
+    return true;
+  } else {
+    emberEventControlSetDelayMS(StateMachineEvent, next_time - now);
+  }
+
+  return false;
+}
+
+static void ScheduleSession(CommissioningSession_t *session,
+                            const uint32_t now, bool *scheduled,
+                            uint32_t *next_time) {
+  MatchDescriptorQueue_t *queue = &session->queue;
+  bool retired = false;
+
+  if (session->sm.scheduled &&
+      (!*scheduled ||
+       (int32_t)(session->sm.time_to_execute - *next_time) < 0)) {
+    *scheduled = true;
+    *next_time = session->sm.time_to_execute;
+  }
+
+  if (IsIdleTransition(&session->sm.transition)) {
+    // a stopped session takes no more responses
+    CloseQueue(queue);
+  } else if (IsSessionCollecting(session) &&
+             (!*scheduled ||
+              (int32_t)(now + IDENTIFY_POLL_PERIOD - *next_time) < 0)) {
+    // the responses callback doesn't wake the session up, it looks for
+    // the remotes queued in the meantime by itself
+    *scheduled = true;
+    *next_time = now + IDENTIFY_POLL_PERIOD;
+  }
+
+  for (QueueIndex_t pos = 0; pos < GetQueueSize(queue); ++pos) {
+    MatchDescriptorReq_t *in_dev = GetInDeviceDescriptor(queue, pos);
+
+    if (in_dev->stage == SC_REMOTE_NEW) {
+      // queued since the session's run, collect it right away
+      *scheduled = true;
+      *next_time = now;
+    }
+    if (in_dev->stage != SC_REMOTE_IN_FLIGHT) {
+      continue;
+    }
+    if (IsIdleTransition(&in_dev->sm.transition)) {
+      in_dev->stage = SC_REMOTE_DONE;
+      retired = true;
+    } else if (in_dev->sm.scheduled &&
+               (!*scheduled ||
+                (int32_t)(in_dev->sm.time_to_execute - *next_time) < 0)) {
+      *scheduled = true;
+      *next_time = in_dev->sm.time_to_execute;
+    }
+  }
+
+  // remotes leave the queue in order, so a processed remote keeps its slot
+  // until every remote ahead of it is processed too
+  for (MatchDescriptorReq_t *in_dev = GetTopInDeviceDescriptor(queue);
+       in_dev != NULL && in_dev->stage == SC_REMOTE_DONE;
+       in_dev = GetTopInDeviceDescriptor(queue)) {
+    PopInDeviceDescriptor(queue);
+  }
+
+  if (retired && session->sm.transition.next_state == SC_EZ_BIND &&
+      session->sm.transition.next_event == SC_EZEV_CHECK_QUEUE) {
+    // let the session fill the discovery window up again
+    session->sm.scheduled = true;
+    session->sm.time_to_execute = now;
+    *next_time = now;
+    *scheduled = true;
+  }
+}
+
+static void CollectNewDevices(const uint32_t now) {
+  MatchDescriptorQueue_t *queue = &current_session->queue;
+  QueueIndex_t pos = GetQueueSize(queue);
+  bool collected = false;
+
+  // remotes are pushed at the end, so the new ones are the last
+  for (; pos > 0; --pos) {
+    MatchDescriptorReq_t *in_dev = GetInDeviceDescriptor(queue, pos - 1);
+
+    if (in_dev->stage != SC_REMOTE_NEW) {
+      break;
+    }
+    if (IsSessionCollecting(current_session)) {
+      in_dev->stage = SC_REMOTE_QUEUED;
+      UpdateIdentifyWindow();
+      collected = true;
+    } else {
+      // queued as the session stopped collecting, just let it go
+      in_dev->stage = SC_REMOTE_DONE;
+    }
+  }
+
+  if (collected) {
+    // ID Query received -> let the session put the remote in flight
+    current_session->sm.transition.next_state = SC_EZ_BIND;
+    current_session->sm.transition.next_event = SC_EZEV_CHECK_QUEUE;
+    current_session->sm.scheduled = true;
+    current_session->sm.time_to_execute = now;
+  }
+}
+
+static void AdmitQueuedDevices(void) {
+  MatchDescriptorQueue_t *queue = &current_session->queue;
+  uint8_t in_flight = 0;
+
+  for (QueueIndex_t pos = 0;
+       pos < GetQueueSize(queue) && in_flight < DISCOVERY_WINDOW; ++pos) {
+    MatchDescriptorReq_t *in_dev = GetInDeviceDescriptor(queue, pos);
+
+    if (in_dev->stage == SC_REMOTE_QUEUED) {
+      emberAfDebugPrintln("DEBUG: Remote 0x%2X in flight", in_dev->source);
+      in_dev->stage = SC_REMOTE_IN_FLIGHT;
+      PushDeviceContext(in_dev);
+      SetContextActive();
+      PopDeviceContext();
+    }
+    if (in_dev->stage == SC_REMOTE_IN_FLIGHT) {
+      ++in_flight;
+    }
+  }
+}
+
+static bool LookupLocalEUI64(void) {
+  MatchDescriptorReq_t *in_dev = GetCurrentDevice();
+  EmberEUI64 eui64;
+
+  if (in_dev->lookups & (SC_LOOKUP_EUI64_KNOWN | SC_LOOKUP_EUI64_LOCAL_DONE)) {
+    return (in_dev->lookups & SC_LOOKUP_EUI64_KNOWN) != 0;
+  }
+
+  in_dev->lookups |= SC_LOOKUP_EUI64_LOCAL_DONE;
+  if (emberLookupEui64ByNodeId(in_dev->source, eui64) != EMBER_SUCCESS) {
+    ++commissioning_stats.eui64_local_misses;
+    return false;
+  }
+
+  emberAfDebugPrintln("DEBUG: EUI64 of 0x%2X is known locally",
+                      in_dev->source);
+  ++commissioning_stats.eui64_local_hits;
+  SetInConnEUI64Address(eui64);
+  in_dev->lookups |= SC_LOOKUP_EUI64_KNOWN;
+  ValidateCachedDescriptors(in_dev->source, eui64);
+
+  return true;
+}
+
+static bool LookupCachedDescriptor(void) {
+  MatchDescriptorReq_t *in_dev = GetCurrentDevice();
+  tokTypeSimpleCommissioningDescriptor descriptor;
+  uint8_t index = DESCRIPTOR_NOT_CACHED;
+
+  if (DESCRIPTOR_CACHE_SIZE == 0 ||
+      (in_dev->lookups & SC_LOOKUP_DESCRIPTOR_CACHED)) {
+    return false;
+  }
+
+  in_dev->lookups |= SC_LOOKUP_DESCRIPTOR_CACHED;
+  // the stack's tables tell for sure whose descriptor to take, otherwise
+  // trust the short ID the descriptor was cached with until the IEEE
+  // address response tells whether the remote is still the cached one
+  if (LookupLocalEUI64()) {
+    index = FindCachedDescriptor(in_dev->source_eui64, in_dev->source_ep);
+  } else {
+    index = FindCachedDescriptorByNodeId(in_dev->source, in_dev->source_ep);
+  }
+
+  if (index == DESCRIPTOR_NOT_CACHED) {
+    ++commissioning_stats.descriptor_cache_misses;
+    return false;
+  }
+
+  emberAfDebugPrintln("DEBUG: Descriptor of 0x%2X is cached", in_dev->source);
+  ++commissioning_stats.descriptor_cache_hits;
+  GetCachedDescriptor(index, &descriptor);
+  if (!(in_dev->lookups & SC_LOOKUP_EUI64_KNOWN)) {
+    // MatchingCheck asks for the EUI64 as it is not known yet
+    SetInConnEUI64Address(descriptor.eui64);
+    in_dev->lookups |= SC_LOOKUP_EUI64_UNVERIFIED;
+  }
+
+  EmberAfClusterList clusters = {
+      .inClusterCount = descriptor.in_count,
+      .inClusterList = descriptor.clusters,
+      .outClusterCount = descriptor.out_count,
+      .outClusterList = descriptor.clusters + descriptor.in_count,
+      .profileId = descriptor.profile_id,
+      .deviceId = descriptor.device_id,
+      .endpoint = descriptor.endpoint};
+  MatchDescriptorClusters(&clusters);
+
+  return true;
+}
+
+static MatchDescriptorReq_t *FindInFlightDevice(
+    const EmberNodeId source, const uint8_t endpoint, const uint8_t lookup,
+    CommissioningSession_t **session) {
+  MatchDescriptorReq_t *found = NULL;
+
+  // endpoints of a remote might await the same kind of response at once.
+  // The stack answers and times requests out in the order they were sent,
+  // so a response that doesn't tell its endpoint is the oldest request's
+  for (uint8_t i = 0; i < CONCURRENT_SESSIONS; ++i) {
+    MatchDescriptorQueue_t *queue = &commissioning_sessions[i].queue;
+
+    // sessions of the same network asking the same remote get the same
+    // answers, so any of them might take the first one
+    if (commissioning_sessions[i].network_index !=
+        emberGetCurrentNetwork()) {
+      continue;
+    }
+    for (QueueIndex_t pos = 0; pos < GetQueueSize(queue); ++pos) {
+      MatchDescriptorReq_t *in_dev = GetInDeviceDescriptor(queue, pos);
+
+      if (in_dev->stage == SC_REMOTE_IN_FLIGHT && in_dev->source == source &&
+          (in_dev->lookups & lookup) &&
+          (endpoint == SC_ANY_ENDPOINT || in_dev->source_ep == endpoint) &&
+          (found == NULL ||
+           (int32_t)(GetLookupSentMs(&commissioning_sessions[i], in_dev,
+                                     lookup) -
+                     GetLookupSentMs(*session, found, lookup)) < 0)) {
+        *session = &commissioning_sessions[i];
+        found = in_dev;
+      }
+    }
+  }
+
+  return found;
+}
+
+static inline uint32_t GetLookupSentMs(CommissioningSession_t *session,
+                                       const MatchDescriptorReq_t *in_dev,
+                                       const uint8_t lookup) {
+  switch (lookup) {
+    case SC_LOOKUP_DESCRIPTOR_PENDING:
+      return in_dev->descriptor_sent_ms;
+    case SC_LOOKUP_EUI64_PENDING:
+      return in_dev->eui64_sent_ms;
+    default:
+      // a remote awaiting Configure Reporting responses has a record
+      return FindReporting(session, in_dev, SC_ANY_CLUSTER)->sent_ms;
+  }
+}
+
+static CommissioningSession_t *FindSession(const uint8_t endpoint) {
+  for (uint8_t i = 0; i < CONCURRENT_SESSIONS; ++i) {
+    const CommissioningSession_t *session = &commissioning_sessions[i];
+
+    if (IsSessionIdle(session)) {
+      continue;
+    }
+    for (uint8_t local = 0; local < session->dev_comm_count; ++local) {
+      if (session->dev_comm[local].ep == endpoint) {
+        return &commissioning_sessions[i];
+      }
+    }
+  }
+
+  return NULL;
+}
+
+static MatchDescriptorQueue_t *FindIdentifyQueue(const uint8_t endpoint) {
+  for (uint8_t i = 0; i < CONCURRENT_SESSIONS; ++i) {
+    MatchDescriptorQueue_t *queue = &commissioning_sessions[i].queue;
+
+    if (IsQueueOpenFor(queue, endpoint)) {
+      return queue;
+    }
+  }
+
+  return NULL;
 }
 
 /** @brief Identify Cluster Identify Query Response
@@ -259,29 +891,32 @@ void emberAfPluginSimpleCommissioningInitiatorStateMachineEventHandler(void) {
  * @param timeout   Ver.: always
  */
 boolean emberAfIdentifyClusterIdentifyQueryResponseCallback(int16u timeout) {
-  // TODO: !!! IMPORTANT !!! add  handling for several responses
-  // now the state machine might be broken as we use only one global variable
-  // for storing incoming connection information like Short ID and endpoint
-  //
   // ignore broadcasts from yourself and from devices that are not
   // in the identifying state
   const EmberAfClusterCommand *const current_cmd = emberAfCurrentCommand();
   if (emberAfGetNodeId() != current_cmd->source && timeout != 0) {
     emberAfDebugPrintln("DEBUG: Got ID Query response");
     emberAfDebugPrintln("DEBUG: Sender 0x%2X", emberAfCurrentCommand()->source);
-    // Queue is empty, so we can start commissioning process
-    // otherwise we push it in the queue and will process later
-    if (GetQueueSize() == 0) {
-      // ID Query received -> go to the discover state for getting clusters info
-      emberAfDebugPrintln("DEBUG: QUEUE IS EMPTY");
-      SetNextState(SC_EZ_DISCOVER);
-      SetNextEvent(SC_EZEV_CHECK_CLUSTERS);
-      emberEventControlSetActive(StateMachineEvent);
+    // the response is addressed to the endpoint of the session that sent
+    // the Identify Query. The callback might run in another context than
+    // the state machine, so the session's queue is all it touches: whether
+    // the session still collects and waking it up are the session's own
+    MatchDescriptorQueue_t *queue =
+        FindIdentifyQueue(current_cmd->apsFrame->destinationEndpoint);
+
+    if (queue != NULL &&
+        IsInDeviceKnown(queue, current_cmd->source,
+                        current_cmd->apsFrame->sourceEndpoint)) {
+      // repeated response, the remote is queued or processed already
+      emberAfDebugPrintln("DEBUG: Duplicated ID Query response");
+    } else if (queue != NULL) {
+      // Store information about endpoint and short ID of the incoming
+      // response for further processing in the pipeline, every remote device
+      // runs its own state machine instance. The session collects the remote
+      // on its next run
+      SetInConnBaseInfo(queue, current_cmd->source,
+                        current_cmd->apsFrame->sourceEndpoint);
     }
-    // Store information about endpoint and short ID of the incoming response
-    // for further processing in the Matching (SC_EZ_MATCH) state
-    SetInConnBaseInfo(current_cmd->source,
-                      current_cmd->apsFrame->sourceEndpoint);
     emberAfSendImmediateDefaultResponse(EMBER_ZCL_STATUS_SUCCESS);
   }
 
@@ -293,10 +928,22 @@ static CommissioningState_t StartCommissioning(void) {
   emberAfDebugPrintln("DEBUG: Commissioning Start");
   // TODO: here we might add some sanity check like cluster existense
   // or something like that, but now just start commissioning process
-  // init internal queue for processing several remote devices
-  InitQueue();
+  // open the queue for processing several remote devices, responses to
+  // the session's Identify Query are addressed to its first endpoint
+  OpenQueue(&current_session->queue, current_session->dev_comm[0].ep);
+  for (uint8_t i = 0; i < REPORTING_RECORDS; ++i) {
+    current_session->reporting[i].remote = NULL;
+  }
+  current_session->reporting_in_flight = 0;
+  current_session->discovery_refusals = 0;
+  // the binding table might have been changed since the last session.
+  // Sessions running already keep the mirror and the cache up to date
+  if (!IsAnotherSessionRunning()) {
+    InitBindingMirror();
+    InitDescriptorCache();
+  }
   SetNextEvent(SC_EZEV_CHECK_NETWORK);
-  emberEventControlSetActive(StateMachineEvent);
+  SetContextActive();
 
   return SC_EZ_START;
 }
@@ -308,8 +955,7 @@ static CommissioningState_t CheckNetwork(void) {
   if (nw_status == EMBER_JOINING_NETWORK ||
       nw_status == EMBER_LEAVING_NETWORK) {
     // Try to check again after 5 seconds
-    emberEventControlSetDelayQS(StateMachineEvent,
-                                SIMPLE_COMMISSIONING_NETWORK_RETRY_DELAY);
+    SetContextDelayQS(SIMPLE_COMMISSIONING_NETWORK_RETRY_DELAY);
 
     return SC_EZ_START;
   }
@@ -330,7 +976,7 @@ static CommissioningState_t CheckNetwork(void) {
 
   // if the device is in the network continue commissioning
   // by sending Identify Query
-  emberEventControlSetActive(StateMachineEvent);
+  SetContextActive();
 
   return SC_EZ_START;
 }
@@ -339,7 +985,9 @@ static CommissioningState_t BroadcastIdentifyQuery(void) {
   emberAfDebugPrintln("DEBUG: Broadcast ID Query");
   // Make Identify cluster's command to send an Identify Query
   emberAfFillCommandIdentifyClusterIdentifyQuery();
-  emberAfSetCommandEndpoints(dev_comm_session.ep, EMBER_BROADCAST_ENDPOINT);
+  // responses come to the first endpoint, they serve all of them
+  emberAfSetCommandEndpoints(current_session->dev_comm[0].ep,
+                             EMBER_BROADCAST_ENDPOINT);
   // Broadcast Identify Query
   EmberStatus status =
       emberAfSendCommandBroadcast(EMBER_SLEEPY_BROADCAST_ADDRESS);
@@ -347,12 +995,15 @@ static CommissioningState_t BroadcastIdentifyQuery(void) {
   if (status != EMBER_SUCCESS) {
     // Exceptional case. Stop commissioning
     SetNextEvent(SC_EZEV_UNKNOWN);
+    SetContextActive();
+
+    return SC_EZ_WAIT_IDENT_RESP;
   }
 
-  // Schedule event for awaiting for responses for 1 second
-  // TODO: Set hardcoded value as plugin's option parameter as optional value
-  emberEventControlSetDelayMS(StateMachineEvent,
-                              SIMPLE_COMMISSIONING_IDENTIFY_RESPONSE_WAIT_TIME());
+  // Schedule event for awaiting for responses till the window closes
+  OpenIdentifyWindow();
+  SetContextDelayMS(current_session->identify_window_end -
+                    halCommonGetInt32uMillisecondTick());
   // If Identify Query responses won't be received state machine just will call
   // Timeout handler
   SetNextEvent(SC_EZEV_TIMEOUT);
@@ -370,85 +1021,108 @@ static CommissioningState_t UnknownState(void) {
   return SC_EZ_STOP;
 }
 
+static bool RetryDiscovery(void) {
+  if (current_session->discovery_refusals >=
+      SIMPLE_COMMISSIONING_DISCOVERY_RETRIES) {
+    // the stack keeps refusing, the network is probably down
+    emberAfDebugPrintln("DEBUG: Discovery of 0x%2X cannot be sent",
+                        GetCurrentDevice()->source);
+    return false;
+  }
+
+  // the stack is probably busy with other discoveries, try again later
+  ++current_session->discovery_refusals;
+  SetNextEvent(SC_EZEV_CHECK_CLUSTERS);
+  SetContextDelayMS(SIMPLE_COMMISSIONING_DISCOVERY_RETRY_DELAY);
+
+  return true;
+}
+
 static CommissioningState_t CheckClusters(void) {
   emberAfDebugPrintln("DEBUG: Check Clusters handler");
   // ask a responded device for providing with info about clusters and call
   // the callback
-  MatchDescriptorReq_t *in_dev = GetTopInDeviceDescriptor();
+  MatchDescriptorReq_t *in_dev = GetCurrentDevice();
   assert(in_dev != NULL);
   emberAfDebugPrintln("DEBUG: short ID 0x%2X", in_dev->source);
   emberAfDebugPrintln("DEBUG: ep 0x%X", in_dev->source_ep);
+  if (LookupCachedDescriptor()) {
+    // a known remote goes straight to matching
+    return SC_EZ_MATCH;
+  }
+
   EmberStatus status = emberAfFindClustersByDeviceAndEndpoint(
       in_dev->source, in_dev->source_ep, ProcessServiceDiscovery);
 
-  // Nothing to do here with states as the next event will become clear
-  // during the ProcessServiceDiscovery callback call
-  SetNextEvent(SC_EZEV_UNKNOWN);
-
-  return (status != EMBER_SUCCESS) ? SC_EZ_UNKNOWN : SC_EZ_DISCOVER;
-}
-
-static inline uint8_t FindUnusedBindingIndex(void) {
-  EmberBindingTableEntry entry = {0};
-
-  for (size_t i = 0; i < emberBindingTableSize; ++i) {
-    if (emberGetBinding(i, &entry) != EMBER_SUCCESS) {
-      // something bad happened with Binding Table
-      emberAfDebugPrintln("DEBUG: error: cannot get the binding entry");
-      return EMBER_APPLICATION_ERROR_0;
+  if (status != EMBER_SUCCESS) {
+    if (!RetryDiscovery()) {
+      SetNextEvent(SC_EZEV_BAD_DISCOVER);
+      SetContextActive();
     }
 
-    if (entry.type == EMBER_UNUSED_BINDING) {
-      return i;
-    }
+    return SC_EZ_DISCOVER;
+  }
+
+  current_session->discovery_refusals = 0;
+  in_dev->lookups |= SC_LOOKUP_DESCRIPTOR_PENDING;
+  in_dev->descriptor_sent_ms = halCommonGetInt32uMillisecondTick();
+#ifdef EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_CONCURRENT_LOOKUPS
+  // don't wait for the descriptor, ask for EUI64 right now. Binding joins
+  // both answers, EUI64 is just dropped if the remote doesn't match.
+  // In case the stack is out of discovery states MatchingCheck asks later
+  if (!(in_dev->lookups & (SC_LOOKUP_EUI64_PENDING | SC_LOOKUP_EUI64_KNOWN)) &&
+      !LookupLocalEUI64() &&
+      emberAfFindIeeeAddress(in_dev->source, ProcessEUI64Discovery) ==
+          EMBER_SUCCESS) {
+    in_dev->lookups |= SC_LOOKUP_EUI64_PENDING;
+    in_dev->eui64_sent_ms = halCommonGetInt32uMillisecondTick();
   }
+#endif  // EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_CONCURRENT_LOOKUPS
+  // Nothing to do here with states as the next event will become clear
+  // during the ProcessServiceDiscovery callback call
+  SetNextEvent(SC_EZEV_UNKNOWN);
 
-  // Binding table is full
-  return EMBER_APPLICATION_ERROR_1;
+  return SC_EZ_DISCOVER;
 }
 
-static inline void InitBindingTableEntry(const EmberEUI64 remote_eui64,
-                                         const uint16_t cluster_id,
-                                         const uint8_t remote_ep,
-                                         EmberBindingTableEntry *entry) {
+static inline void InitBindingTableEntry(
+    const MatchDescriptorReq_t *const in_dev, const uint16_t bit,
+    EmberBindingTableEntry *entry) {
   entry->type = EMBER_UNICAST_BINDING;
-  entry->local = dev_comm_session.ep;
-  entry->remote = remote_ep;
-  entry->clusterId = cluster_id;
-  MEMCOPY(entry->identifier, remote_eui64, EUI64_SIZE);
+  entry->local = current_session->dev_comm[GetRemoteClusterLocal(bit)].ep;
+  entry->remote = in_dev->source_ep;
+  entry->clusterId = GetRemoteClusterId(bit);
+  MEMCOPY(entry->identifier, in_dev->source_eui64, EUI64_SIZE);
 }
 
 static bool CreateBindings(const MatchDescriptorReq_t *const in_dev) {
   // here we add bindings to the binding table
   EmberStatus status = EMBER_SUCCESS;
 
-  for (size_t i = 0; i < in_dev->source_cl_arr_len; ++i) {
-    if (!IsSkipCluster(i)) {
-      uint8_t bindex = FindUnusedBindingIndex();
+  // visit only clusters left in the mask
+  for (uint16_t i = NextRemoteCluster(0); i < REMOTE_CLUSTERS_MASK_BITS;
+       i = NextRemoteCluster(i + 1)) {
+    uint16_t bindex = FindUnusedBinding();
 
-      if (bindex == EMBER_APPLICATION_ERROR_0 ||
-          bindex == EMBER_APPLICATION_ERROR_1) {
-        // error during finding an available binding table index for write to
-        // Check query in that case
-        // TODO: handle error
-        return false;
-      }
+    if (bindex == BINDING_NOT_FOUND) {
+      // Binding table is full
+      // TODO: handle error
+      return false;
+    }
 
-      EmberBindingTableEntry new_binding;
-      InitBindingTableEntry(in_dev->source_eui64, in_dev->source_cl_arr[i],
-                            in_dev->source_ep, &new_binding);
-      status = emberSetBinding(bindex, &new_binding);
-      if (status == EMBER_SUCCESS) {
-        // Set up the remote short ID for binding for avoiding ZDO broadcast
-        emberSetBindingRemoteNodeId(bindex, in_dev->source);
-      }
-      // DEBUG
-      emberGetBinding(bindex, &new_binding);
-      emberAfDebugPrintln("DEBUG: remote ep 0x%X", new_binding.remote);
-      emberAfDebugPrintln("DEBUG: cluster id 0x%X%X",
-                          HIGH_BYTE(new_binding.clusterId),
-                          LOW_BYTE(new_binding.clusterId));
+    EmberBindingTableEntry new_binding;
+    InitBindingTableEntry(in_dev, i, &new_binding);
+    status = emberSetBinding(bindex, &new_binding);
+    if (status == EMBER_SUCCESS) {
+      // Set up the remote short ID for binding for avoiding ZDO broadcast
+      emberSetBindingRemoteNodeId(bindex, in_dev->source);
+      UpdateMirroredBinding(bindex, &new_binding);
     }
+    // DEBUG
+    emberAfDebugPrintln("DEBUG: remote ep 0x%X", new_binding.remote);
+    emberAfDebugPrintln("DEBUG: cluster id 0x%X%X",
+                        HIGH_BYTE(new_binding.clusterId),
+                        LOW_BYTE(new_binding.clusterId));
   }
 
   // all bindings successfully added
@@ -457,39 +1131,102 @@ static bool CreateBindings(const MatchDescriptorReq_t *const in_dev) {
 
 static CommissioningState_t SetBinding(void) {
   emberAfDebugPrintln("DEBUG: Set Binding");
-  MatchDescriptorReq_t *in_dev = GetTopInDeviceDescriptor();
+  MatchDescriptorReq_t *in_dev = GetCurrentDevice();
   assert(in_dev != NULL);
-  // init clusters skip mask length for checking for duplicates in the binding
-  // table
-  InitRemoteSkipCluster(in_dev->source_cl_arr_len);
-  // check the supported clusters list for existence in the binding table
+  // check the supported clusters for existence in the binding table
   MarkDuplicateMatches(in_dev);
-  // nothing to do if we unmarked all clusters
-  if (GetRemoteSkipMask() == 0) {
-    SetNextEvent(SC_EZEV_CHECK_QUEUE);
-    emberEventControlSetActive(StateMachineEvent);
+  // nothing to do if we unmarked all clusters or have no room for them
+  if (CountRemoteClusters() == 0 || GetUnusedBindingsCount() == 0) {
+    SetNextEvent(SC_EZEV_NOT_MATCHED);
   } else if (CreateBindings(in_dev)) {
     // Create bindings for supported clusters
     SetNextEvent(SC_EZEV_BINDING_DONE);
   } else {
-    SetNextEvent(SC_EZEV_CHECK_QUEUE);
+    SetNextEvent(SC_EZEV_NOT_MATCHED);
   }
 
-  PopInDeviceDescriptor();
-  emberAfDebugPrintln("DEBUG: Supported clusters mask 0x%X",
-                      skip_mask.skip_clusters);
-  emberEventControlSetActive(StateMachineEvent);
+  emberAfDebugPrintln("DEBUG: Supported clusters to bind %d",
+                      CountRemoteClusters());
+  SetContextActive();
 
   return SC_EZ_BIND;
 }
 
 static CommissioningState_t BindingDone(void) {
   emberAfDebugPrintln("DEBUG: Binding Done");
-  // as we've processed the current remote device delete it from the queue
-  SetNextEvent(SC_EZEV_CHECK_QUEUE);
-  emberEventControlSetActive(StateMachineEvent);
+  if (REPORTING_WINDOW > 0 && PlanReporting()) {
+    // bound clusters get their reporting configured before the remote
+    // leaves the pipeline
+    SetNextEvent(SC_EZEV_CONFIGURE_REPORTING);
+    SetContextActive();
 
-  return SC_EZ_BIND;
+    return SC_EZ_REPORT;
+  }
+  // as we've processed the current remote device it leaves the queue
+  SetNextEvent(SC_EZEV_IDLE);
+
+  return SC_EZ_STOP;
+}
+
+static CommissioningState_t ConfigureReporting(void) {
+  emberAfDebugPrintln("DEBUG: Configure Reporting");
+  MatchDescriptorReq_t *in_dev = GetCurrentDevice();
+  assert(in_dev != NULL);
+  const uint32_t now = halCommonGetInt32uMillisecondTick();
+  const uint32_t wait_time =
+      GetResponseWaitTime(current_session->network_index);
+  ReportingRecord_t *record =
+      FindReporting(current_session, in_dev, SC_ANY_CLUSTER);
+
+  // responses that did not come in time stop holding the window. They
+  // might be left to the application, so the round trip estimator
+  // doesn't back off for them
+  while (record != NULL && now - record->sent_ms >= wait_time) {
+    ++commissioning_stats.reporting_timeouts;
+    ReleaseReporting(record);
+    record = FindReporting(current_session, in_dev, SC_ANY_CLUSTER);
+  }
+  // clusters left in the mask still wait for their request
+  for (uint16_t i = NextRemoteCluster(0);
+       i < REMOTE_CLUSTERS_MASK_BITS &&
+       current_session->reporting_in_flight < REPORTING_WINDOW;
+       i = NextRemoteCluster(i + 1)) {
+    SkipRemoteCluster(i);
+    if (SendConfigureReporting(in_dev, i)) {
+      ++commissioning_stats.reporting_requests;
+      AddReporting(in_dev, GetRemoteClusterId(i), now);
+    }
+  }
+
+  record = FindReporting(current_session, in_dev, SC_ANY_CLUSTER);
+  if (CountRemoteClusters() == 0 && record == NULL) {
+    SetNextEvent(SC_EZEV_REPORTING_DONE);
+    SetContextActive();
+  } else {
+    // responses and the window getting free wake the remote up earlier
+    SetNextEvent(SC_EZEV_CONFIGURE_REPORTING);
+    SetContextDelayMS((record != NULL) ? record->sent_ms + wait_time - now
+                                       : wait_time);
+  }
+
+  return SC_EZ_REPORT;
+}
+
+static CommissioningState_t RemoteDone(void) {
+  emberAfDebugPrintln("DEBUG: Remote 0x%2X done", GetCurrentDevice()->source);
+  // remote device without anything to bind leaves the queue
+  SetNextEvent(SC_EZEV_IDLE);
+
+  return SC_EZ_STOP;
+}
+
+static CommissioningState_t EUI64Timeout(void) {
+  emberAfDebugPrintln("DEBUG: No EUI64 of 0x%2X", GetCurrentDevice()->source);
+  // the wait window was too short for that remote, widen it for
+  // the next ones until a response comes in time
+  BackOffRtt(current_session->network_index);
+
+  return RemoteDone();
 }
 
 static CommissioningState_t StopCommissioning(void) {
@@ -505,108 +1242,287 @@ static CommissioningState_t StopCommissioning(void) {
 static void MarkDuplicateMatches(const MatchDescriptorReq_t *const in_dev) {
   // Check if we already have any from requested clusters from a remote
   EmberBindingTableEntry entry = {0};
-  // run through the incoming device's clusters list and check if
-  // we already have any binding entries
-  for (size_t i = 0; i < in_dev->source_cl_arr_len; ++i) {
-    for (size_t j = 0; j < emberBindingTableSize; ++j) {
-      if (emberGetBinding(j, &entry) != EMBER_SUCCESS) {
-        break;
-      }
-      // if a binding entry not marked as unused and
-      // current info are the same as in a request
-      if (entry.type != EMBER_UNUSED_BINDING &&
-          entry.local == dev_comm_session.ep &&
-          entry.clusterId == in_dev->source_cl_arr[i] &&
-          entry.remote == in_dev->source_ep &&
-          MEMCOMPARE(entry.identifier, in_dev->source_eui64, EUI64_SIZE) == 0) {
-        SkipRemoteCluster(i);
-        break;
-      }
+  // run through the incoming device's clusters and look each cluster's
+  // binding up in the binding table mirror
+  for (uint16_t i = NextRemoteCluster(0); i < REMOTE_CLUSTERS_MASK_BITS;
+       i = NextRemoteCluster(i + 1)) {
+    InitBindingTableEntry(in_dev, i, &entry);
+    if (FindBinding(&entry) != BINDING_NOT_FOUND) {
+      SkipRemoteCluster(i);
+    }
+  }
+}
+
+static bool PlanReporting(void) {
+  for (uint16_t i = NextRemoteCluster(0); i < REMOTE_CLUSTERS_MASK_BITS;
+       i = NextRemoteCluster(i + 1)) {
+    const uint16_t cluster_id = GetRemoteClusterId(i);
+    const ClusterMatcher_t *matcher =
+        &current_session->dev_comm[GetRemoteClusterLocal(i)].matcher;
+    bool configure = IsClusterReported(cluster_id) &&
+                     FindLocalCluster(matcher, cluster_id, SC_ROLE_CLIENT) !=
+                         CLUSTER_NOT_FOUND;
+
+    // remotes report attributes of their server clusters, those bound to
+    // a local client cluster. A cluster bound from several local endpoints
+    // is configured once
+    for (uint16_t j = NextRemoteCluster(0); configure && j < i;
+         j = NextRemoteCluster(j + 1)) {
+      configure = GetRemoteClusterId(j) != cluster_id;
+    }
+    if (!configure) {
+      SkipRemoteCluster(i);
+    }
+  }
+
+  return CountRemoteClusters() != 0;
+}
+
+static bool SendConfigureReporting(const MatchDescriptorReq_t *const in_dev,
+                                   const uint16_t bit) {
+  const uint16_t cluster_id = GetRemoteClusterId(bit);
+  const uint8_t local_ep =
+      current_session->dev_comm[GetRemoteClusterLocal(bit)].ep;
+  EmberEUI64 local_eui64;
+  EmberEUI64 remote_eui64;
+
+  if (FillConfigureReporting(cluster_id) == 0) {
+    return false;
+  }
+  // reports follow the remote's binding table, so it needs one back to
+  // the local endpoint. The Bind response is not awaited: Configure
+  // Reporting right after it is no worse than reports without a binding
+  emberAfGetEui64(local_eui64);
+  MEMCOPY(remote_eui64, in_dev->source_eui64, EUI64_SIZE);
+  if (emberBindRequest(in_dev->source, remote_eui64, in_dev->source_ep,
+                       cluster_id, UNICAST_BINDING, local_eui64, 0, local_ep,
+                       EMBER_AF_DEFAULT_APS_OPTIONS) != EMBER_SUCCESS) {
+    return false;
+  }
+  emberAfSetCommandEndpoints(local_ep, in_dev->source_ep);
+
+  return emberAfSendCommandUnicast(EMBER_OUTGOING_DIRECT, in_dev->source) ==
+         EMBER_SUCCESS;
+}
+
+static void AddReporting(MatchDescriptorReq_t *in_dev,
+                         const uint16_t cluster_id, const uint32_t now) {
+  ReportingRecord_t *record = current_session->reporting;
+
+  // the reporting window keeps a free record for every request
+  while (record->remote != NULL) {
+    ++record;
+  }
+  record->sent_ms = now;
+  record->remote = in_dev;
+  record->cluster_id = cluster_id;
+  ++current_session->reporting_in_flight;
+  ++in_dev->reporting_pending;
+  in_dev->lookups |= SC_LOOKUP_REPORTING_PENDING;
+}
+
+static ReportingRecord_t *FindReporting(CommissioningSession_t *session,
+                                        const MatchDescriptorReq_t *in_dev,
+                                        const uint16_t cluster_id) {
+  ReportingRecord_t *found = NULL;
+
+  for (uint8_t i = 0; i < REPORTING_RECORDS; ++i) {
+    ReportingRecord_t *record = &session->reporting[i];
+
+    if (record->remote == in_dev &&
+        (cluster_id == SC_ANY_CLUSTER || record->cluster_id == cluster_id) &&
+        (found == NULL || (int32_t)(record->sent_ms - found->sent_ms) < 0)) {
+      found = record;
+    }
+  }
+
+  return found;
+}
+
+static void ReleaseReporting(ReportingRecord_t *record) {
+  MatchDescriptorReq_t *in_dev = record->remote;
+  MatchDescriptorQueue_t *queue = &current_session->queue;
+  const uint32_t now = halCommonGetInt32uMillisecondTick();
+
+  record->remote = NULL;
+  --in_dev->reporting_pending;
+  --current_session->reporting_in_flight;
+  if (in_dev->reporting_pending == 0) {
+    in_dev->lookups &= ~SC_LOOKUP_REPORTING_PENDING;
+  }
+
+  for (QueueIndex_t pos = 0; pos < GetQueueSize(queue); ++pos) {
+    MatchDescriptorReq_t *remote = GetInDeviceDescriptor(queue, pos);
+
+    if (remote->stage == SC_REMOTE_IN_FLIGHT &&
+        remote->sm.transition.next_state == SC_EZ_REPORT &&
+        remote->sm.transition.next_event == SC_EZEV_CONFIGURE_REPORTING) {
+      remote->sm.time_to_execute = now;
+      remote->sm.scheduled = true;
     }
   }
 }
 
 static CommissioningState_t MatchingCheck(void) {
   emberAfDebugPrintln("DEBUG: Matching Check");
-  MatchDescriptorReq_t *in_dev = GetTopInDeviceDescriptor();
+  MatchDescriptorReq_t *in_dev = GetCurrentDevice();
   assert(in_dev != NULL);
-  EmberStatus status =
-      emberAfFindIeeeAddress(in_dev->source, ProcessEUI64Discovery);
 
-  if (status == EMBER_SUCCESS) {
-    SetNextEvent(SC_EZEV_AWAIT_EUI64);
-  } else {
-    SetNextEvent(SC_EZEV_CHECK_QUEUE);
+  if ((in_dev->lookups & SC_LOOKUP_EUI64_KNOWN) ||
+      (!(in_dev->lookups & SC_LOOKUP_EUI64_PENDING) && LookupLocalEUI64())) {
+    // EUI64 came while we were waiting for the descriptor or
+    // the stack knows it already
+    SetNextEvent(SC_EZEV_BIND);
+    SetContextActive();
+
+    return SC_EZ_BIND;
+  }
+
+  if (!(in_dev->lookups & SC_LOOKUP_EUI64_PENDING)) {
+    EmberStatus status =
+        emberAfFindIeeeAddress(in_dev->source, ProcessEUI64Discovery);
+
+    if (status != EMBER_SUCCESS) {
+      if (!RetryDiscovery()) {
+        SetNextEvent(SC_EZEV_BAD_DISCOVER);
+        SetContextActive();
+      }
+
+      return SC_EZ_MATCH;
+    }
+
+    current_session->discovery_refusals = 0;
+    in_dev->lookups |= SC_LOOKUP_EUI64_PENDING;
+    in_dev->eui64_sent_ms = halCommonGetInt32uMillisecondTick();
   }
+
+  SetNextEvent(SC_EZEV_AWAIT_EUI64);
   // await for EUI64 response
-  emberEventControlSetDelayMS(StateMachineEvent,
-                              SIMPLE_COMMISSIONING_EUI64_RESPONSE_WAIT_TIME());
+  SetContextDelayMS(SIMPLE_COMMISSIONING_EUI64_RESPONSE_WAIT_TIME());
 
   return SC_EZ_BIND;
 }
 
 static CommissioningState_t CheckQuery(void) {
   emberAfDebugPrintln("DEBUG: Check query");
-  CommissioningState_t next_st = SC_EZ_UNKNOWN;
 
-  if (GetQueueSize() != 0) {
-    SetNextEvent(SC_EZEV_CHECK_CLUSTERS);
-    next_st = SC_EZ_DISCOVER;
-  } else {
+  int32_t window_left = (int32_t)(current_session->identify_window_end -
+                                  halCommonGetInt32uMillisecondTick());
+
+  if (GetQueueSize(&current_session->queue) == 0 && window_left > 0) {
+    // remotes might be processed faster than they respond (e.g. served
+    // from the descriptors cache), keep collecting until the window closes.
+    // New responses wake the session up and might move the window's end
+    SetNextEvent(SC_EZEV_CHECK_QUEUE);
+    SetContextDelayMS((uint32_t)window_left);
+  } else if (GetQueueSize(&current_session->queue) == 0) {
     SetNextEvent(SC_EZEV_QUEUE_EMPTY);
-    next_st = SC_EZ_BIND;
+    SetContextActive();
+  } else {
+    // put as much remotes in flight as the discovery window allows,
+    // processed remotes wake the session up again
+    AdmitQueuedDevices();
+    SetNextEvent(SC_EZEV_CHECK_QUEUE);
   }
 
-  emberEventControlSetActive(StateMachineEvent);
-
-  return next_st;
+  return SC_EZ_BIND;
 }
 
-static inline void InitRemoteSkipCluster(const uint16_t length) {
-  // as init we don't want to skip anything
-  skip_mask.len = length;
-  skip_mask.skip_clusters = (1 << skip_mask.len) - 1;
+static inline void ClearRemoteClusters(void) {
+  RemoteClusters_t *clusters = &GetCurrentDevice()->clusters;
+
+  MEMSET(clusters->mask, 0, sizeof(clusters->mask));
+  clusters->count = 0;
 }
 
-static inline void SkipRemoteCluster(const uint16_t pos) {
-  EMBER_TEST_ASSERT(pos < skip_mask->len);
+static inline void SkipRemoteCluster(const uint16_t bit) {
+  RemoteClusters_t *clusters = &GetCurrentDevice()->clusters;
+  EMBER_TEST_ASSERT(bit < REMOTE_CLUSTERS_MASK_BITS);
   // just clean the appropriate bit
-  skip_mask.skip_clusters &= ~(1 << pos);
+  clusters->mask[bit / 32] &= ~(1UL << (bit % 32));
+}
+
+static inline uint16_t CountRemoteClusters(void) {
+  const RemoteClusters_t *clusters = &GetCurrentDevice()->clusters;
+  uint16_t count = 0;
+
+  for (uint16_t word = 0; word < REMOTE_CLUSTERS_MASK_WORDS; ++word) {
+    count += CountSetBits(clusters->mask[word]);
+  }
+
+  return count;
+}
+
+static inline uint16_t NextRemoteCluster(uint16_t bit) {
+  const RemoteClusters_t *clusters = &GetCurrentDevice()->clusters;
+
+  for (uint16_t word = bit / 32; word < REMOTE_CLUSTERS_MASK_WORDS; ++word) {
+    // drop bits below @bit in its own word
+    uint32_t bits = clusters->mask[word];
+    if (word == bit / 32) {
+      bits &= 0xFFFFFFFFUL << (bit % 32);
+    }
+    if (bits != 0) {
+      return word * 32 + FindFirstSetBit(bits);
+    }
+  }
+
+  return REMOTE_CLUSTERS_MASK_BITS;
 }
 
-static inline uint16_t GetRemoteSkipMask(void) {
-  return skip_mask.skip_clusters;
+static inline uint8_t GetRemoteClusterLocal(const uint16_t bit) {
+  return (uint8_t)(bit / LOCAL_CLUSTERS_MASK_BITS);
 }
 
-static inline bool IsSkipCluster(uint16_t pos) {
-  return !(BIT(pos) & skip_mask.skip_clusters);
+static inline uint16_t GetRemoteClusterId(const uint16_t bit) {
+  const ClusterMatcher_t *matcher =
+      &current_session->dev_comm[GetRemoteClusterLocal(bit)].matcher;
+
+  return GetLocalCluster(matcher, (uint8_t)(bit % LOCAL_CLUSTERS_MASK_BITS));
 }
 
-static inline uint8_t CheckSupportedClusters(
+static inline bool CheckSupportedClusters(
+    const uint8_t local, const LocalRole_t role,
     const uint16_t *incoming_cl_list, const uint8_t incoming_cl_list_len) {
-  bool unused = true;
-  uint8_t supported_clusters_cnt = 0;
+  const ClusterMatcher_t *matcher = &current_session->dev_comm[local].matcher;
 
   for (size_t i = 0; i < incoming_cl_list_len; ++i) {
-    // just run through the current device's cluster list and if
-    // that incoming cluster exists on our device then don't exclude it
-    for (size_t j = 0; j < dev_comm_session.clusters_arr_len; ++j) {
-      if (incoming_cl_list[i] == dev_comm_session.clusters[j]) {
-        // our device support it
-        ++supported_clusters_cnt;
-        unused = false;
-        break;
-      }
+    // look the incoming cluster up in the local endpoint's cluster list and
+    // if it exists on our device then store it for binding
+    uint8_t pos = FindLocalCluster(matcher, incoming_cl_list[i], role);
+    if (pos == CLUSTER_NOT_FOUND) {
+      continue;
     }
-
-    if (unused) {
-      SkipRemoteCluster(i);
+    if (!AddRemoteCluster(local, pos)) {
+      emberAfDebugPrintln("DEBUG: WARNING: remote clusters list is full");
+      return false;
     }
+    emberAfDebugPrintln("DEBUG: Supported cluster 0x%X%X",
+                        HIGH_BYTE(incoming_cl_list[i]),
+                        LOW_BYTE(incoming_cl_list[i]));
+  }
+
+  return true;
+}
+
+static inline bool AddRemoteCluster(const uint8_t local, const uint8_t pos) {
+  RemoteClusters_t *clusters = &GetCurrentDevice()->clusters;
+  const uint16_t bit = (uint16_t)(local * LOCAL_CLUSTERS_MASK_BITS + pos);
+  const uint32_t bit_mask = 1UL << (bit % 32);
 
-    unused = true;
+  if (clusters->mask[bit / 32] & bit_mask) {
+    // an endpoint with both roles matches clusters the remote has in both
+    // lists twice
+    return true;
+  }
+  if (clusters->count == INCOMING_DEVICE_CLUSTERS_LIST_LEN) {
+    return false;
   }
 
-  return supported_clusters_cnt;
+  clusters->mask[bit / 32] |= bit_mask;
+  ++clusters->count;
+
+  return true;
 }
 
 static CommissioningState_t FormJoinNetwork(void) {
@@ -632,89 +1548,298 @@ static CommissioningState_t FormJoinNetwork(void) {
 
   IncNetworkTries();
   // run state machine again after 10 seconds
-  emberEventControlSetDelayQS(StateMachineEvent,
-                              SIMPLE_COMMISSIONING_NETWORK_CHECK_RETRY_TIME);
+  SetContextDelayQS(SIMPLE_COMMISSIONING_NETWORK_CHECK_RETRY_TIME);
 
   return SC_EZ_START;
 }
 
 /// Get current attempt
-static inline uint8_t GetNetworkTries(void) { return network_access_tries; }
+static inline uint8_t GetNetworkTries(void) {
+  return current_session->network_access_tries;
+}
 /// Increment current attempt
-static inline void IncNetworkTries(void) { ++network_access_tries; }
+static inline void IncNetworkTries(void) {
+  ++current_session->network_access_tries;
+}
 /// Clear variable
-static inline void ClearNetworkTries(void) { network_access_tries = 0; }
+static inline void ClearNetworkTries(void) {
+  current_session->network_access_tries = 0;
+}
+
+static bool IsAnotherSessionRunning(void) {
+  for (uint8_t i = 0; i < CONCURRENT_SESSIONS; ++i) {
+    if (&commissioning_sessions[i] != current_session &&
+        !IsSessionIdle(&commissioning_sessions[i])) {
+      return true;
+    }
+  }
+
+  return false;
+}
 
 CommissioningState_t CommissioningStateMachineStatus(void) {
-  return GetNextState();
+  for (uint8_t i = 0; i < CONCURRENT_SESSIONS; ++i) {
+    if (commissioning_sessions[i].sm.transition.next_state != SC_EZ_STOP) {
+      return commissioning_sessions[i].sm.transition.next_state;
+    }
+  }
+
+  return SC_EZ_STOP;
+}
+
+CommissioningState_t CommissioningSessionStatus(const uint8_t endpoint) {
+  const CommissioningSession_t *session = FindSession(endpoint);
+
+  return (session != NULL) ? session->sm.transition.next_state : SC_EZ_STOP;
+}
+
+CommissioningSession_t *AcquireCommissioningSession(
+    const SimpleCommissioningEndpoint_t *endpoints, const uint8_t count) {
+  for (uint8_t i = 0; i < count; ++i) {
+    if (FindSession(endpoints[i].endpoint) != NULL) {
+      // the endpoint is being commissioned already
+      return NULL;
+    }
+  }
+
+  for (uint8_t i = 0; i < CONCURRENT_SESSIONS; ++i) {
+    if (IsSessionIdle(&commissioning_sessions[i])) {
+      return &commissioning_sessions[i];
+    }
+  }
+
+  return NULL;
+}
+
+void CommissioningStateMachineWakeUp(CommissioningSession_t *session) {
+  session->sm.scheduled = true;
+  session->sm.time_to_execute = halCommonGetInt32uMillisecondTick();
+  ScheduleStateMachine();
+}
+
+static void MatchLocalEndpoint(const uint8_t local,
+                               const EmberAfClusterList *const clusters,
+                               const uint32_t fingerprint) {
+  DevCommClusters_t *dev_comm = &current_session->dev_comm[local];
+  RemoteClusters_t *remote = &GetCurrentDevice()->clusters;
+  // the endpoint's own words of the remote's mask
+  uint32_t *mask = &remote->mask[local * LOCAL_CLUSTERS_MASK_WORDS];
+  // identical remotes (same model) get the same clusters to bind
+  const MatchResult_t *result =
+      FindMatchResult(&dev_comm->match_results, fingerprint, clusters);
+
+  if (result != NULL) {
+    uint16_t count = 0;
+
+    ++commissioning_stats.match_results_hits;
+    for (uint8_t word = 0; word < LOCAL_CLUSTERS_MASK_WORDS; ++word) {
+      count += CountSetBits(result->clusters[word]);
+    }
+    if (remote->count + count <= INCOMING_DEVICE_CLUSTERS_LIST_LEN) {
+      MEMCOPY(mask, result->clusters, sizeof(result->clusters));
+      remote->count += (uint8_t)count;
+      return;
+    }
+    // only a part of the result fits
+    for (uint8_t word = 0; word < LOCAL_CLUSTERS_MASK_WORDS; ++word) {
+      for (uint32_t bits = result->clusters[word]; bits != 0;
+           bits &= bits - 1) {
+        if (!AddRemoteCluster(local,
+                              (uint8_t)(word * 32 + FindFirstSetBit(bits)))) {
+          return;
+        }
+      }
+    }
+  } else {
+    // check how much clusters our device wants to bind to and
+    // update our incoming device structure with them: local client
+    // clusters bind to the remote's server (in) clusters and local server
+    // clusters to its client (out) ones
+    ++commissioning_stats.match_results_misses;
+    bool is_complete =
+        CheckSupportedClusters(local, SC_ROLE_CLIENT, clusters->inClusterList,
+                               clusters->inClusterCount) &&
+        CheckSupportedClusters(local, SC_ROLE_SERVER,
+                               clusters->outClusterList,
+                               clusters->outClusterCount);
+    // clusters cut by the remote's limit are not what identical remotes
+    // match
+    if (is_complete) {
+      StoreMatchResult(&dev_comm->match_results, fingerprint, clusters, mask);
+    }
+  }
+}
+
+static CommissioningState_t MatchDescriptorClusters(
+    const EmberAfClusterList *const clusters) {
+  MatchDescriptorReq_t *in_dev = GetCurrentDevice();
+  uint32_t fingerprint = GetDescriptorFingerprint(clusters);
+
+  // one descriptor serves every local endpoint of the session
+  ClearRemoteClusters();
+  for (uint8_t local = 0; local < current_session->dev_comm_count; ++local) {
+    MatchLocalEndpoint(local, clusters, fingerprint);
+  }
+  uint8_t supported_clusters = in_dev->clusters.count;
+
+  emberAfDebugPrintln("DEBUG: Supported clusters %d", supported_clusters);
+  if (supported_clusters == 0 &&
+      !(in_dev->lookups & SC_LOOKUP_EUI64_UNVERIFIED)) {
+    // we should not do anything with that remote device
+    SetNextEvent(SC_EZEV_NOT_MATCHED);
+  } else {
+    // Now we have all information about responded device's clusters
+    // Start matching procedure for checking how much of them fit for our
+    // device. A descriptor that might be another remote's goes on to the
+    // IEEE address request even without matches, so the entry gets checked
+    SetNextEvent(SC_EZEV_CHECK_CLUSTERS);
+  }
+  SetContextActive();
+
+  return SC_EZ_MATCH;
+}
+
+/*! Configure Reporting Response of the application's callback. Responses
+    to the plugin's requests free the reporting window, the rest are left
+    to the application. Records a remote rejected are only logged */
+bool ConfigureReportingResponse(const EmberAfClusterId clusterId,
+                                const uint8_t *buffer, const uint16_t bufLen) {
+  const EmberAfClusterCommand *const current_cmd = emberAfCurrentCommand();
+  CommissioningSession_t *session = NULL;
+  MatchDescriptorReq_t *in_dev =
+      FindInFlightDevice(current_cmd->source,
+                         current_cmd->apsFrame->sourceEndpoint,
+                         SC_LOOKUP_REPORTING_PENDING, &session);
+
+  if (in_dev == NULL) {
+    // not a response to the plugin's request
+    return false;
+  }
+
+  // a single success status means every record was accepted
+  if (bufLen != 1 || buffer[0] != EMBER_ZCL_STATUS_SUCCESS) {
+    emberAfDebugPrintln("DEBUG: Remote 0x%2X rejected reporting of 0x%2X",
+                        in_dev->source, clusterId);
+  }
+  ReportingRecord_t *record = FindReporting(session, in_dev, clusterId);
+
+  // every request configures a cluster of its own, take the oldest one if
+  // the response doesn't match any
+  if (record == NULL) {
+    record = FindReporting(session, in_dev, SC_ANY_CLUSTER);
+  }
+  SetSessionContext(session);
+  ReleaseReporting(record);
+  ScheduleStateMachine();
+
+  return true;
 }
 
 /*! Callback for Simple Descriptor Request */
 static void ProcessServiceDiscovery(
     const EmberAfServiceDiscoveryResult *result) {
+  // only responses with data tell the endpoint
+  const uint8_t endpoint =
+      emberAfHaveDiscoveryResponseStatus(result->status)
+          ? ((const EmberAfClusterList *)result->responseData)->endpoint
+          : SC_ANY_ENDPOINT;
+  CommissioningSession_t *session = NULL;
+  MatchDescriptorReq_t *in_dev =
+      FindInFlightDevice(result->matchAddress, endpoint,
+                         SC_LOOKUP_DESCRIPTOR_PENDING, &session);
+
+  if (in_dev == NULL) {
+    // response for a remote device that is not waiting for it anymore
+    return;
+  }
+
+  SetSessionContext(session);
+  in_dev->lookups &= ~SC_LOOKUP_DESCRIPTOR_PENDING;
+  if (emberAfHaveDiscoveryResponseStatus(result->status)) {
+    AddRttSample(session->network_index,
+                 halCommonGetInt32uMillisecondTick() -
+                     in_dev->descriptor_sent_ms);
+  }
+  PushDeviceContext(in_dev);
   // if we get a matche or a default response handle it
-  // otherwise stop commissioning or go to the next incoming device
+  // otherwise go to the next incoming device
   if (emberAfHaveDiscoveryResponseStatus(result->status)) {
     EmberAfClusterList *discovered_clusters =
         (EmberAfClusterList *)result->responseData;
 
-    // if our device requested to bind to server clusters (is_server parameter
-    // during the SimpleCommissioningStart was FALSE) -> use inClusterList of
-    // the incoming device's response
-    // otherwise -> outClusterList (as our device has server clusters)
-    const uint16_t *inc_clusters_arr = (dev_comm_session.is_server)
-                                           ? discovered_clusters->outClusterList
-                                           : discovered_clusters->inClusterList;
-    // get correct lenght of the incoming clusters array
-    const uint8_t inc_clusters_arr_len =
-        (dev_comm_session.is_server) ? discovered_clusters->outClusterCount
-                                     : discovered_clusters->inClusterCount;
-    // init clusters skip mask length for further using
-    InitRemoteSkipCluster(inc_clusters_arr_len);
-    // check how much clusters our device wants to bind to
-    uint8_t supported_clusters =
-        CheckSupportedClusters(inc_clusters_arr, inc_clusters_arr_len);
-
-    emberAfDebugPrintln("DEBUG: Supported clusters %d", supported_clusters);
-    if (supported_clusters == 0) {
-      // we should not do anything with that, just wait maybe another response
-      // would come
-      SetNextEvent(SC_EZEV_TIMEOUT);
-      SetNextState(SC_EZ_WAIT_IDENT_RESP);
-      emberEventControlSetDelayMS(
-          StateMachineEvent, SIMPLE_COMMISSIONING_IDENTIFY_RESPONSE_WAIT_TIME());
-    } else {
-      // update our incoming device structure with information about clusters
-      SetInDevicesClustersInfo(inc_clusters_arr, inc_clusters_arr_len,
-                               supported_clusters);
-      // Now we have all information about responded device's clusters
-      // Start matching procedure for checking how much of them fit for our
-      // device
-      SetNextEvent(SC_EZEV_CHECK_CLUSTERS);
-      SetNextState(SC_EZ_MATCH);
-      emberEventControlSetActive(StateMachineEvent);
-    }
+    SetNextState(MatchDescriptorClusters(discovered_clusters));
+    // the EUI64 is added to the cache entry later if it is not known yet
+    CacheDescriptor(in_dev->source, in_dev->source_ep,
+                    (in_dev->lookups & SC_LOOKUP_EUI64_KNOWN)
+                        ? in_dev->source_eui64
+                        : NULL,
+                    discovered_clusters);
   } else {
-    // we should not do anything with that, just wait maybe another response
-    // would come
-    SetNextEvent(SC_EZEV_TIMEOUT);
-    SetNextState(SC_EZ_WAIT_IDENT_RESP);
-    emberEventControlSetDelayMS(
-        StateMachineEvent, SIMPLE_COMMISSIONING_IDENTIFY_RESPONSE_WAIT_TIME());
+    // we should not do anything with that remote device
+    SetNextEvent(SC_EZEV_BAD_DISCOVER);
+    SetNextState(SC_EZ_DISCOVER);
+    SetContextActive();
   }
+
+  PopDeviceContext();
+  ScheduleStateMachine();
 }
 
 /*! Callback for IEEE address Request */
 static void ProcessEUI64Discovery(const EmberAfServiceDiscoveryResult *result) {
+  CommissioningSession_t *session = NULL;
+  MatchDescriptorReq_t *in_dev =
+      FindInFlightDevice(result->matchAddress, SC_ANY_ENDPOINT,
+                         SC_LOOKUP_EUI64_PENDING, &session);
+
+  if (in_dev == NULL) {
+    // response for a remote device that is not waiting for it anymore
+    return;
+  }
+
+  SetSessionContext(session);
+  in_dev->lookups &= ~SC_LOOKUP_EUI64_PENDING;
+  if (emberAfHaveDiscoveryResponseStatus(result->status)) {
+    AddRttSample(session->network_index,
+                 halCommonGetInt32uMillisecondTick() - in_dev->eui64_sent_ms);
+  }
+  PushDeviceContext(in_dev);
+  bool stale_descriptor = false;
   if (emberAfHaveDiscoveryResponseStatus(result->status)) {
-    MatchDescriptorReq_t *in_dev = GetTopInDeviceDescriptor();
-    assert(in_dev != NULL);
-    SetInConnEUI64Address((const uint8_t *)result->responseData);
+    const uint8_t *eui64 = (const uint8_t *)result->responseData;
+
+    // the descriptor was served by a short ID that another remote has now
+    stale_descriptor = (in_dev->lookups & SC_LOOKUP_EUI64_UNVERIFIED) &&
+                       MEMCOMPARE(in_dev->source_eui64, eui64, EUI64_SIZE) != 0;
+    in_dev->lookups &= ~SC_LOOKUP_EUI64_UNVERIFIED;
+    SetInConnEUI64Address(eui64);
+    in_dev->lookups |= SC_LOOKUP_EUI64_KNOWN;
+    // evicts the stale entry from the short ID
+    ValidateCachedDescriptors(in_dev->source, in_dev->source_eui64);
     emberAfDebugPrint("DEBUG: EUI64 ");
     emberAfPrintLittleEndianEui64(in_dev->source_eui64);
     emberAfDebugPrintln("");
-    SetNextEvent(SC_EZEV_BIND);
   }
 
-  emberEventControlSetActive(StateMachineEvent);
+  // the remote might still wait for its descriptor, then MatchingCheck
+  // picks the result up
+  if (GetNextState() == SC_EZ_BIND && GetNextEvent() == SC_EZEV_AWAIT_EUI64) {
+    if (stale_descriptor) {
+      // look the remote up again by its real EUI64, the cache or a Simple
+      // Descriptor request tells its clusters
+      ++commissioning_stats.descriptor_cache_stale;
+      in_dev->lookups &= ~SC_LOOKUP_DESCRIPTOR_CACHED;
+      SetNextState(SC_EZ_DISCOVER);
+      SetNextEvent(SC_EZEV_CHECK_CLUSTERS);
+    } else if (in_dev->clusters.count == 0 &&
+               (in_dev->lookups & SC_LOOKUP_EUI64_KNOWN)) {
+      // the cached descriptor was the remote's, nothing of it matches
+      SetNextEvent(SC_EZEV_NOT_MATCHED);
+    } else if (in_dev->lookups & SC_LOOKUP_EUI64_KNOWN) {
+      SetNextEvent(SC_EZEV_BIND);
+    }
+    SetContextActive();
+  }
+  PopDeviceContext();
+  ScheduleStateMachine();
 }
@@ -2,10 +2,11 @@
 #define SIMPLE_COMMISSIONING_INITIATOR_INTERNAL_H
 
 #include "app/framework/include/af.h"
+#include "simple-commissioning-initiator.h"
 #include "simple-commissioning-td.h"
 
 /// External variables used by internal and/or public implementation
-extern DevCommClusters_t dev_comm_session;
+extern SimpleCommissioningStats_t commissioning_stats;
 extern EmberEventControl
     emberAfPluginSimpleCommissioningInitiatorStateMachineEventControl;
 
@@ -14,6 +15,20 @@ extern EmberEventControl
   emberAfPluginSimpleCommissioningInitiatorStateMachineEventControl
 
 /// Public interface for interface for plugin's internal implementation
+/// State of the first running session, SC_EZ_STOP if none is running
 CommissioningState_t CommissioningStateMachineStatus(void);
+/// State of the session running on the @endpoint, SC_EZ_STOP if there is
+/// none
+CommissioningState_t CommissioningSessionStatus(const uint8_t endpoint);
+/// Idle session a new session on the @count @endpoints might take, NULL if
+/// all of them run or one of them runs on one of the @endpoints already
+CommissioningSession_t *AcquireCommissioningSession(
+    const SimpleCommissioningEndpoint_t *endpoints, const uint8_t count);
+/// Schedule the @session's pending transition right away
+void CommissioningStateMachineWakeUp(CommissioningSession_t *session);
+/// Take a Configure Reporting response if it answers a request of
+/// the plugin, false if it is the application's
+bool ConfigureReportingResponse(const EmberAfClusterId clusterId,
+                                const uint8_t *buffer, const uint16_t bufLen);
 
 #endif  // SIMPLE_COMMISSIONING_INITIATOR_INTERNAL_H
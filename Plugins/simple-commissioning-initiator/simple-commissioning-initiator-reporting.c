@@ -0,0 +1,95 @@
+// *******************************************************************
+// * simple-commissioning-initiator-reporting.c
+// *
+// * Attribute reporting policy applied to remotes right after they are
+// * bound: every bound cluster gets a single Configure Reporting request
+// * carrying all of its attributes from the policy table
+// *
+// *******************************************************************
+
+#include "simple-commissioning-initiator-reporting.h"
+
+/*! Globals for storing the application's reporting policy table
+ */
+static const SimpleCommissioningReporting_t *reporting_policy = NULL;
+static uint8_t reporting_policy_len = 0;
+
+// Reporting private interface
+static uint8_t PutReportingRecord(
+    uint8_t *payload, const SimpleCommissioningReporting_t *const entry);
+
+static uint8_t PutReportingRecord(
+    uint8_t *payload, const SimpleCommissioningReporting_t *const entry) {
+  uint8_t change_size = 0;
+  uint8_t len = 0;
+
+  if (emberAfGetAttributeAnalogOrDiscreteType(entry->data_type) ==
+      EMBER_AF_DATA_TYPE_ANALOG) {
+    change_size = emberAfGetDataSize(entry->data_type);
+  }
+
+  payload[len++] = EMBER_ZCL_REPORTING_DIRECTION_REPORTED;
+  payload[len++] = LOW_BYTE(entry->attribute_id);
+  payload[len++] = HIGH_BYTE(entry->attribute_id);
+  payload[len++] = entry->data_type;
+  payload[len++] = LOW_BYTE(entry->min_interval);
+  payload[len++] = HIGH_BYTE(entry->min_interval);
+  payload[len++] = LOW_BYTE(entry->max_interval);
+  payload[len++] = HIGH_BYTE(entry->max_interval);
+  // little endian, wider types get the change zero extended
+  for (uint8_t i = 0; i < change_size; ++i) {
+    payload[len++] =
+        (i < sizeof(entry->reportable_change))
+            ? (uint8_t)((entry->reportable_change >> (8 * i)) & 0xFF)
+            : 0;
+  }
+
+  return len;
+}
+
+void SetReportingPolicy(const SimpleCommissioningReporting_t *policy,
+                        const uint8_t count) {
+  reporting_policy = policy;
+  reporting_policy_len = (policy != NULL) ? count : 0;
+}
+
+bool IsClusterReported(const uint16_t cluster_id) {
+  for (uint8_t i = 0; i < reporting_policy_len; ++i) {
+    if (reporting_policy[i].cluster_id == cluster_id) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+uint8_t FillConfigureReporting(const uint16_t cluster_id) {
+  // the longest record: header and an 8 bytes reportable change
+  uint8_t record[8 + 8];
+  uint8_t payload[REPORTING_PAYLOAD_LEN];
+  uint16_t payload_len = 0;
+  uint8_t records = 0;
+
+  for (uint8_t i = 0; i < reporting_policy_len; ++i) {
+    if (reporting_policy[i].cluster_id != cluster_id) {
+      continue;
+    }
+
+    uint8_t record_len = PutReportingRecord(record, &reporting_policy[i]);
+    if (payload_len + record_len > REPORTING_PAYLOAD_LEN) {
+      emberAfDebugPrintln("DEBUG: WARNING: attribute 0x%2X does not fit",
+                          reporting_policy[i].attribute_id);
+      continue;
+    }
+    MEMCOPY(payload + payload_len, record, record_len);
+    payload_len += record_len;
+    ++records;
+  }
+
+  if (records != 0) {
+    emberAfFillCommandGlobalClientToServerConfigureReporting(
+        cluster_id, payload, payload_len);
+  }
+
+  return records;
+}
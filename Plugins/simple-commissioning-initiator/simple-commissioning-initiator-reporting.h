@@ -0,0 +1,28 @@
+#ifndef SIMPLE_COMMISSIONING_INITIATOR_REPORTING_H
+#define SIMPLE_COMMISSIONING_INITIATOR_REPORTING_H
+
+#include "app/framework/include/af.h"
+#include "simple-commissioning-initiator.h"
+
+/*! \define REPORTING_PAYLOAD_LEN
+
+    Room for attribute reporting records in one Configure Reporting
+    request (in bytes)
+*/
+#define REPORTING_PAYLOAD_LEN \
+  (EMBER_AF_MAXIMUM_SEND_PAYLOAD_LENGTH - EMBER_AF_ZCL_OVERHEAD)
+
+/// Functions for configuring attribute reporting on bound remotes.
+/// The policy table is shared by all sessions
+/// Use the @count entries of @policy from now on, NULL disables reporting
+/// configuration
+void SetReportingPolicy(const SimpleCommissioningReporting_t *policy,
+                        const uint8_t count);
+/// Whether the policy has attributes of @cluster_id
+bool IsClusterReported(const uint16_t cluster_id);
+/// Fill a Configure Reporting request with the policy's attributes of
+/// @cluster_id. Returns the number of attribute records, 0 if there are
+/// none and nothing was filled
+uint8_t FillConfigureReporting(const uint16_t cluster_id);
+
+#endif  // SIMPLE_COMMISSIONING_INITIATOR_REPORTING_H
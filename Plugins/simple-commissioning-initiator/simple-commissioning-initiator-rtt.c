@@ -0,0 +1,86 @@
+// *******************************************************************
+// * simple-commissioning-initiator-rtt.c
+// *
+// * Round trip time estimator per network (Jacobson/Karels in fixed
+// * point, as TCP does), so response wait windows follow the network
+// * instead of a value fitting neither one-hop nor deep meshes
+// *
+// *******************************************************************
+
+#include "simple-commissioning-initiator-rtt.h"
+
+/// Wait window of a request answered after the responder's next poll
+static inline uint32_t GetPollWaitTime(void);
+
+/*! Globals for storing the networks' estimators
+ */
+static SimpleCommissioningRttEstimator_t
+    rtt_estimators[EMBER_SUPPORTED_NETWORKS];
+
+void AddRttSample(const uint8_t network_index, const uint32_t rtt_ms) {
+  if (network_index >= EMBER_SUPPORTED_NETWORKS) {
+    return;
+  }
+
+  SimpleCommissioningRttEstimator_t *rtt = &rtt_estimators[network_index];
+  // keep scaled values far from overflow
+  uint32_t sample = (rtt_ms > RTT_MAX_WAIT_TIME) ? RTT_MAX_WAIT_TIME : rtt_ms;
+
+  if (rtt->samples == 0) {
+    rtt->srtt = sample << 3;
+    rtt->rttvar = sample << 1;
+  } else {
+    // srtt += (sample - srtt) / 8, rttvar += (|sample - srtt| - rttvar) / 4
+    int32_t error = (int32_t)sample - (int32_t)(rtt->srtt >> 3);
+
+    rtt->srtt = (uint32_t)((int32_t)rtt->srtt + error);
+    if (error < 0) {
+      error = -error;
+    }
+    rtt->rttvar = rtt->rttvar + (uint32_t)error - (rtt->rttvar >> 2);
+  }
+
+  rtt->backoff = 0;
+  ++rtt->samples;
+}
+
+void BackOffRtt(const uint8_t network_index) {
+  if (network_index < EMBER_SUPPORTED_NETWORKS &&
+      rtt_estimators[network_index].backoff < RTT_MAX_BACKOFF) {
+    ++rtt_estimators[network_index].backoff;
+  }
+}
+
+uint32_t GetResponseWaitTime(const uint8_t network_index) {
+  if (network_index >= EMBER_SUPPORTED_NETWORKS ||
+      rtt_estimators[network_index].samples == 0) {
+    return GetPollWaitTime();
+  }
+
+  const SimpleCommissioningRttEstimator_t *rtt = &rtt_estimators[network_index];
+  uint32_t wait_time = ((rtt->srtt >> 3) + rtt->rttvar) << rtt->backoff;
+
+  if (wait_time < RTT_MIN_WAIT_TIME) {
+    return RTT_MIN_WAIT_TIME;
+  }
+
+  return (wait_time > RTT_MAX_WAIT_TIME) ? RTT_MAX_WAIT_TIME : wait_time;
+}
+
+uint32_t GetBroadcastWaitTime(const uint8_t network_index) {
+  uint32_t wait_time = GetResponseWaitTime(network_index);
+  uint32_t poll_wait_time = GetPollWaitTime();
+
+  return (wait_time > poll_wait_time) ? wait_time : poll_wait_time;
+}
+
+const SimpleCommissioningRttEstimator_t *GetRttEstimator(
+    const uint8_t network_index) {
+  return (network_index < EMBER_SUPPORTED_NETWORKS)
+             ? &rtt_estimators[network_index]
+             : NULL;
+}
+
+static inline uint32_t GetPollWaitTime(void) {
+  return 2 * emberAfGetShortPollIntervalMsCallback() + 100;
+}
@@ -0,0 +1,43 @@
+#ifndef SIMPLE_COMMISSIONING_INITIATOR_RTT_H
+#define SIMPLE_COMMISSIONING_INITIATOR_RTT_H
+
+#include "app/framework/include/af.h"
+#include "simple-commissioning-initiator.h"
+
+/*! \define RTT_MIN_WAIT_TIME
+
+    Lower bound of a response wait window (in milliseconds)
+*/
+#define RTT_MIN_WAIT_TIME 50
+
+/*! \define RTT_MAX_WAIT_TIME
+
+    Upper bound of a response wait window (in milliseconds)
+*/
+#define RTT_MAX_WAIT_TIME 30000UL
+
+/*! \define RTT_MAX_BACKOFF
+
+    Maximal number of wait window doublings
+*/
+#define RTT_MAX_BACKOFF 5
+
+/// Functions for working with the per-network round trip time estimators
+/// Account a response that came @rtt_ms after its request on the network
+/// @network_index
+void AddRttSample(const uint8_t network_index, const uint32_t rtt_ms);
+/// Account a request on the network @network_index that got no response
+/// within the wait window
+void BackOffRtt(const uint8_t network_index);
+/// Response wait window on the network @network_index (in milliseconds).
+/// Until the first sample it is the stack's 2 * short poll + 100 ms
+uint32_t GetResponseWaitTime(const uint8_t network_index);
+/// Broadcast response wait window on the network @network_index
+/// (in milliseconds). Unicast round trips say nothing of sleepy or far
+/// responders, so it is never shorter than 2 * short poll + 100 ms
+uint32_t GetBroadcastWaitTime(const uint8_t network_index);
+/// Estimator of the network @network_index, NULL for an unsupported one
+const SimpleCommissioningRttEstimator_t *GetRttEstimator(
+    const uint8_t network_index);
+
+#endif  // SIMPLE_COMMISSIONING_INITIATOR_RTT_H
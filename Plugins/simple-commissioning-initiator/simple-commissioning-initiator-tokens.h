@@ -0,0 +1,79 @@
+// *******************************************************************
+// * simple-commissioning-initiator-tokens.h
+// *
+// * Tokens of the Simple Commissioning Initiator plugin. Included by
+// * the stack's token header with DEFINETYPES and with DEFINETOKENS
+// *
+// *******************************************************************
+
+/// Descriptors cached over reboots, one token per remote endpoint
+#define CREATOR_SIMPLE_COMMISSIONING_DESCRIPTORS 0x5344
+
+#ifdef DEFINETYPES
+/*! \define SIMPLE_COMMISSIONING_DESCRIPTOR_CLUSTERS
+
+    Number of in and out clusters (together) a cached descriptor holds.
+    Longer descriptors are not cached
+*/
+#define SIMPLE_COMMISSIONING_DESCRIPTOR_CLUSTERS \
+  EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_COMMISSIONING_CLUSTERS_LIST_LEN
+
+/*! \define SIMPLE_COMMISSIONING_DESCRIPTOR_TOKEN_SIZE
+
+    Size of a cached descriptor's token (in bytes), 18 bytes of the
+    remote's identity and descriptor header and 2 bytes per cluster
+*/
+#define SIMPLE_COMMISSIONING_DESCRIPTOR_TOKEN_SIZE \
+  (18 + 2 * SIMPLE_COMMISSIONING_DESCRIPTOR_CLUSTERS)
+
+/*! \define SIMPLE_COMMISSIONING_TOKEN_MAX_SIZE
+
+    Largest token the Simulated EEPROM stores (in bytes)
+*/
+#define SIMPLE_COMMISSIONING_TOKEN_MAX_SIZE 254
+
+#if EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_DESCRIPTOR_CACHE > 0 && \
+    SIMPLE_COMMISSIONING_DESCRIPTOR_TOKEN_SIZE >                          \
+        SIMPLE_COMMISSIONING_TOKEN_MAX_SIZE
+#error "cached descriptors need a shorter Possible clusters list length"
+#endif
+
+/// tokTypeSimpleCommissioningDescriptor flags
+#define SIMPLE_COMMISSIONING_DESCRIPTOR_VALID 0x01
+#define SIMPLE_COMMISSIONING_DESCRIPTOR_EUI64_KNOWN 0x02
+
+/*! \typedef tokTypeSimpleCommissioningDescriptor
+    \brief Simple descriptor of a remote endpoint
+
+    An erased token (all zeros) is an unused cache entry
+*/
+typedef struct {
+  /// Remote's EUI64 (valid with SIMPLE_COMMISSIONING_DESCRIPTOR_EUI64_KNOWN)
+  uint8_t eui64[8];
+  /// Remote's short ID the descriptor was last seen with
+  uint16_t node_id;
+  /// Endpoint's profile ID
+  uint16_t profile_id;
+  /// Endpoint's device ID
+  uint16_t device_id;
+  /// Remote's endpoint
+  uint8_t endpoint;
+  /// SIMPLE_COMMISSIONING_DESCRIPTOR_* flags
+  uint8_t flags;
+  /// Number of in clusters at the beginning of clusters
+  uint8_t in_count;
+  /// Number of out clusters following the in clusters
+  uint8_t out_count;
+  /// In clusters followed by out clusters
+  uint16_t clusters[SIMPLE_COMMISSIONING_DESCRIPTOR_CLUSTERS];
+} tokTypeSimpleCommissioningDescriptor;
+#endif  // DEFINETYPES
+
+#ifdef DEFINETOKENS
+#if EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_DESCRIPTOR_CACHE > 0
+DEFINE_INDEXED_TOKEN(SIMPLE_COMMISSIONING_DESCRIPTORS,
+                     tokTypeSimpleCommissioningDescriptor,
+                     EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_DESCRIPTOR_CACHE,
+                     {{0}})
+#endif
+#endif  // DEFINETOKENS
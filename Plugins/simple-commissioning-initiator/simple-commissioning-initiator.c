@@ -7,52 +7,163 @@
 
 // Typedefs for Simple Commissioning plugin
 #include "simple-commissioning-initiator.h"
+#include "simple-commissioning-initiator-binding.h"
+#include "simple-commissioning-initiator-cache.h"
+#include "simple-commissioning-initiator-clusters.h"
 #include "simple-commissioning-initiator-internal.h"
+#include "simple-commissioning-initiator-reporting.h"
+#include "simple-commissioning-initiator-rtt.h"
 #include "simple-commissioning-td.h"
 
-/*! Global for storing current device's commissioning information
+/*! Global for storing the plugin's counters
  */
-DevCommClusters_t dev_comm_session;
+SimpleCommissioningStats_t commissioning_stats;
+
+/*! Global for storing the number of remotes expected by the next sessions
+ */
+static uint16_t expected_remotes = 0;
 
 /*! Helper inline function for init DeviceCommissioningClusters struct */
-static inline void InitDeviceCommissionInfo(DevCommClusters_t *dcc,
-                                            const uint8_t ep,
-                                            const bool is_server,
-                                            const uint16_t *clusters_arr,
-                                            const uint8_t clusters_arr_len) {
-  dcc->clusters = clusters_arr;
-  dcc->ep = ep;
-  dcc->clusters_arr_len = clusters_arr_len;
-  // Get a network index for the requested endpoint
-  dcc->network_index = emberAfNetworkIndexFromEndpoint(ep);
-  dcc->is_server = is_server;
+static inline void InitDeviceCommissionInfo(
+    DevCommClusters_t *dcc, const SimpleCommissioningEndpoint_t *endpoint) {
+  dcc->ep = endpoint->endpoint;
+  // every remote in the session is matched against the same lists
+  InitClusterMatcher(&dcc->matcher, endpoint->client_clusters,
+                     endpoint->client_length, endpoint->server_clusters,
+                     endpoint->server_length);
+  InitMatchResults(&dcc->match_results);
+}
+
+/*! Helper function for checking the local endpoint descriptors of
+    a session */
+static EmberStatus CheckEndpoints(
+    const SimpleCommissioningEndpoint_t *endpoints, const uint8_t count) {
+  if (!endpoints || !count || count > SESSION_ENDPOINTS) {
+    return EMBER_BAD_ARGUMENT;
+  }
+
+  const uint16_t unused_bindings = GetUnusedBindingsCount();
+  for (uint8_t i = 0; i < count; ++i) {
+    uint16_t length =
+        (uint16_t)endpoints[i].client_length + endpoints[i].server_length;
+
+    if ((!endpoints[i].client_clusters && endpoints[i].client_length) ||
+        (!endpoints[i].server_clusters && endpoints[i].server_length) ||
+        !length) {
+      // meaningless call if ClusterID array was not passed or its length
+      // is zero
+      return EMBER_BAD_ARGUMENT;
+    }
+    if (length > LOCAL_CLUSTERS_LIST_LEN) {
+      // clusters past the matcher's positions could never be bound
+      return EMBER_BAD_ARGUMENT;
+    }
+    // Identify Query of the session is sent on the network of the first
+    // endpoint
+    if (emberAfNetworkIndexFromEndpoint(endpoints[i].endpoint) !=
+        emberAfNetworkIndexFromEndpoint(endpoints[0].endpoint)) {
+      return EMBER_BAD_ARGUMENT;
+    }
+    for (uint8_t j = 0; j < i; ++j) {
+      if (endpoints[j].endpoint == endpoints[i].endpoint) {
+        return EMBER_BAD_ARGUMENT;
+      }
+    }
+    if (length > unused_bindings) {
+      // passed more clusters than the binding table has room for, the
+      // remotes' clusters that do not fit are left unbound
+      emberAfDebugPrint("Warning: ask for bind 0x%2X clusters. ", length);
+      emberAfDebugPrintln("Unused bindings: 0x%2X", unused_bindings);
+    }
+  }
+
+  return EMBER_SUCCESS;
 }
 
 EmberStatus SimpleCommissioningStart(uint8_t endpoint, bool is_server,
                                      const uint16_t *clusters, uint8_t length) {
-  if (!clusters || !length) {
-    // meaningless call if ClusterID array was not passed or its length
-    // is zero
-    return EMBER_BAD_ARGUMENT;
+  // a single role session
+  const SimpleCommissioningEndpoint_t descriptor = {
+      .endpoint = endpoint,
+      .client_clusters = is_server ? NULL : clusters,
+      .client_length = is_server ? 0 : length,
+      .server_clusters = is_server ? clusters : NULL,
+      .server_length = is_server ? length : 0};
+
+  return SimpleCommissioningStartEndpoints(&descriptor, 1);
+}
+
+EmberStatus SimpleCommissioningStartEndpoints(
+    const SimpleCommissioningEndpoint_t *endpoints, uint8_t count) {
+  EmberStatus status = CheckEndpoints(endpoints, count);
+  if (status != EMBER_SUCCESS) {
+    return status;
   }
   emberAfDebugPrintln("DEBUG: Call for starting commissioning");
-  if (length > emberBindingTableSize) {
-    // passed more clusters than the binding table may handle
-    // TODO: may be it is worth to track available entries to write in
-    // the binding table
-    emberAfDebugPrint("Warning: ask for bind 0x%X clusters. ", length);
-    emberAfDebugPrintln("Binding table size is 0x%X", emberBindingTableSize);
-  }
-  if (CommissioningStateMachineStatus() != SC_EZ_STOP) {
-    // quite implicit, but if our state machine runs then network
-    // probably busy
+  CommissioningSession_t *session =
+      AcquireCommissioningSession(endpoints, count);
+  if (session == NULL) {
+    // quite implicit, but if an endpoint's session runs or all sessions
+    // run then network probably busy
     return EMBER_NETWORK_BUSY;
   }
 
-  InitDeviceCommissionInfo(&dev_comm_session, endpoint, is_server, clusters,
-                           length);
+  for (uint8_t i = 0; i < count; ++i) {
+    InitDeviceCommissionInfo(&session->dev_comm[i], &endpoints[i]);
+  }
+  session->dev_comm_count = count;
+  // Get a network index for the requested endpoints
+  session->network_index =
+      emberAfNetworkIndexFromEndpoint(endpoints[0].endpoint);
+  session->expected_remotes = expected_remotes;
   // Wake up our state machine
-  emberEventControlSetActive(StateMachineEvent);
+  CommissioningStateMachineWakeUp(session);
 
   return EMBER_SUCCESS;
 }
+
+void SimpleCommissioningSetExpectedRemotes(uint16_t count) {
+  expected_remotes = count;
+}
+
+void SimpleCommissioningSetReportingPolicy(
+    const SimpleCommissioningReporting_t *policy, uint8_t count) {
+  SetReportingPolicy(policy, count);
+}
+
+bool SimpleCommissioningConfigureReportingResponse(EmberAfClusterId clusterId,
+                                                   const uint8_t *buffer,
+                                                   uint16_t bufLen) {
+  return ConfigureReportingResponse(clusterId, buffer, bufLen);
+}
+
+void SimpleCommissioningBindingChanged(uint16_t index) {
+  if (index == SIMPLE_COMMISSIONING_UNKNOWN_BINDING) {
+    MarkBindingMirrorStale();
+  } else {
+    SyncMirroredBinding(index);
+  }
+}
+
+void SimpleCommissioningClearDescriptorCache(void) {
+  // keys might be stale if tokens were rewritten since the last session
+  InitDescriptorCache();
+  ClearDescriptorCache();
+}
+
+const SimpleCommissioningRttEstimator_t *SimpleCommissioningGetRttEstimator(
+    uint8_t network_index) {
+  return GetRttEstimator(network_index);
+}
+
+uint32_t SimpleCommissioningGetResponseWaitTime(uint8_t network_index) {
+  return GetResponseWaitTime(network_index);
+}
+
+const SimpleCommissioningStats_t *SimpleCommissioningGetStats(void) {
+  return &commissioning_stats;
+}
+
+void SimpleCommissioningClearStats(void) {
+  MEMSET(&commissioning_stats, 0, sizeof(commissioning_stats));
+}
@@ -5,8 +5,172 @@
 #include <stdint.h>
 #include "app/framework/include/af.h"
 
-/*! Commisioning start functions */
+/// Index passed to SimpleCommissioningBindingChanged() when the index of
+/// the changed binding is not known
+#define SIMPLE_COMMISSIONING_UNKNOWN_BINDING 0xFFFF
+
+/*! \typedef struct SimpleCommissioningEndpoint
+    \brief Local endpoint descriptor of a commissioning session
+
+    Client clusters are bound to remotes' server clusters and server
+    clusters to remotes' client ones, both directions in the same pass.
+    Clusters lists are referenced, not copied, and must outlive the session
+*/
+typedef struct SimpleCommissioningEndpoint {
+  /// Local endpoint the bindings are made from
+  uint8_t endpoint;
+  /// Endpoint's client clusters to bind
+  const uint16_t *client_clusters;
+  /// Length of the client clusters list, 0 if there are none
+  uint8_t client_length;
+  /// Endpoint's server clusters to bind
+  const uint16_t *server_clusters;
+  /// Length of the server clusters list, 0 if there are none
+  uint8_t server_length;
+} SimpleCommissioningEndpoint_t;
+
+/*! \typedef struct SimpleCommissioningReporting
+    \brief Entry of the attribute reporting policy table
+
+    Remotes bound to a local client cluster get their attributes of it
+    configured to report to the local node. Entries of the same cluster
+    are sent in one Configure Reporting request
+*/
+typedef struct SimpleCommissioningReporting {
+  /// Cluster the attribute belongs to
+  uint16_t cluster_id;
+  /// Attribute to report
+  uint16_t attribute_id;
+  /// Attribute's ZCL data type
+  uint8_t data_type;
+  /// Minimal interval between reports (in seconds)
+  uint16_t min_interval;
+  /// Maximal interval between reports (in seconds)
+  uint16_t max_interval;
+  /// Change of the attribute's value triggering a report, used by analog
+  /// data types only
+  uint32_t reportable_change;
+} SimpleCommissioningReporting_t;
+
+/*! \typedef struct SimpleCommissioningStats
+    \brief Plugin's counters
+
+    Counted since boot or the last SimpleCommissioningClearStats call
+*/
+typedef struct SimpleCommissioningStats {
+  /// Remotes' EUI64 found in the local address, child or neighbor table
+  uint32_t eui64_local_hits;
+  /// Remotes' EUI64 asked for with an IEEE address request
+  uint32_t eui64_local_misses;
+  /// Remotes' simple descriptors taken from the descriptors cache
+  uint32_t descriptor_cache_hits;
+  /// Remotes' simple descriptors not found in the descriptors cache
+  uint32_t descriptor_cache_misses;
+  /// Cached simple descriptors served by a short ID that turned out to
+  /// belong to another remote
+  uint32_t descriptor_cache_stale;
+  /// Remotes matched by reusing the result of an identical remote
+  /// (counted per local endpoint of the session)
+  uint32_t match_results_hits;
+  /// Remotes matched against the local clusters list (counted per local
+  /// endpoint of the session)
+  uint32_t match_results_misses;
+  /// Configure Reporting requests sent to bound remotes
+  uint32_t reporting_requests;
+  /// Configure Reporting requests that got no response in time
+  uint32_t reporting_timeouts;
+} SimpleCommissioningStats_t;
+
+/*! \typedef struct SimpleCommissioningRttEstimator
+    \brief State of a network's round trip time estimator
+
+    Fed by every Simple Descriptor and IEEE address response, response
+    wait windows are srtt / 8 + rttvar, doubled per back-off step
+*/
+typedef struct SimpleCommissioningRttEstimator {
+  /// Smoothed round trip time (in 1/8 milliseconds)
+  uint32_t srtt;
+  /// Mean deviation of the round trip time (in 1/4 milliseconds)
+  uint32_t rttvar;
+  /// Number of responses that timed out in a row, each one doubles
+  /// the wait window until the next sample
+  uint8_t backoff;
+  /// Number of samples taken
+  uint32_t samples;
+} SimpleCommissioningRttEstimator_t;
+
+/*! Commisioning start functions. Sessions on different endpoints might
+    run at the same time (up to the Concurrent sessions plugin option),
+    EMBER_NETWORK_BUSY if the @endpoint's session runs already or there is
+    no free session, EMBER_BAD_ARGUMENT if @clusters are longer than
+    the Local clusters list length plugin option */
 EmberStatus SimpleCommissioningStart(uint8_t endpoint, bool is_server,
                                      const uint16_t *clusters, uint8_t length);
 
+/*! Commission several local endpoints in one session: the Identify Query
+    is broadcast from the first endpoint and every remote is discovered
+    once, then matched and bound to each of the @count @endpoints (up to
+    the Session endpoints plugin option). All endpoints must be on the same
+    network, an endpoint might be listed once and its client and server
+    lists together are up to the Local clusters list length plugin option.
+    EMBER_NETWORK_BUSY if one of the endpoints is commissioned already or
+    there is no free session */
+EmberStatus SimpleCommissioningStartEndpoints(
+    const SimpleCommissioningEndpoint_t *endpoints, uint8_t count);
+
+/*! Number of remotes the application expects to answer the Identify Query
+    of the sessions started from now on. Responses are collected until that
+    much remotes are queued or the Identify window limit passes, the quiet
+    period is not used then. 0 (the default) if not known */
+void SimpleCommissioningSetExpectedRemotes(uint16_t count);
+
+/*! Configure attribute reporting on remotes right after they are bound:
+    every bound cluster having entries among the @count entries of @policy
+    gets one Configure Reporting request with all of them, preceded by
+    a ZDO Bind request adding the remote's binding back to the local
+    endpoint the reports are sent to. Up to
+    the Reporting window plugin option requests of a session await their
+    responses at once. The table is referenced, not copied, and must
+    outlive the sessions. NULL (the default) leaves reporting to
+    the application */
+void SimpleCommissioningSetReportingPolicy(
+    const SimpleCommissioningReporting_t *policy, uint8_t count);
+
+/*! Pass a Configure Reporting response to the plugin: the application
+    calls it from its emberAfConfigureReportingResponseCallback, which
+    the plugin leaves to the application. True if the response answers
+    a request of the plugin and is consumed, false if it is
+    the application's. Needed only when a reporting policy is set, without
+    it the Reporting window times requests out */
+bool SimpleCommissioningConfigureReportingResponse(EmberAfClusterId clusterId,
+                                                   const uint8_t *buffer,
+                                                   uint16_t bufLen);
+
+/*! Let the plugin know the binding @index was set or deleted behind its
+    back while commissioning is running: by the application or by a remote
+    node's ZDO Bind or Unbind request, which the application reports from
+    its emberRemoteSetBindingHandler (the index is not known there, pass
+    SIMPLE_COMMISSIONING_UNKNOWN_BINDING) and emberRemoteDeleteBindingHandler.
+    Required with the option Binding changes reported, without it every
+    binding the plugin does not know of costs a binding table scan. Not
+    needed between sessions: every session reads the binding table again */
+void SimpleCommissioningBindingChanged(uint16_t index);
+
+/*! Forget the remotes' descriptors cached in tokens, so the next session
+    asks every remote for its descriptor again (e.g. after remotes got
+    a firmware update changing their clusters) */
+void SimpleCommissioningClearDescriptorCache(void);
+
+/*! Round trip time estimator of the network @network_index, NULL for
+    an unsupported network index */
+const SimpleCommissioningRttEstimator_t *SimpleCommissioningGetRttEstimator(
+    uint8_t network_index);
+/*! Current response wait window of the network @network_index
+    (in milliseconds) */
+uint32_t SimpleCommissioningGetResponseWaitTime(uint8_t network_index);
+
+/*! Plugin's counters */
+const SimpleCommissioningStats_t *SimpleCommissioningGetStats(void);
+void SimpleCommissioningClearStats(void);
+
 #endif  // SIMPLE_COMMISSIONING_PLUGIN_H
\ No newline at end of file
@@ -11,62 +11,266 @@
 #define INCOMING_DEVICE_CLUSTERS_LIST_LEN \
   EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_COMMISSIONING_CLUSTERS_LIST_LEN
 
-/*! \typedef struct DevicesCommissioningClusters
-    \brief Device's clusters for commissioning
+/*! \define LOCAL_CLUSTERS_LIST_LEN
 
-    Storage for device's endpoint and clusters
-    for current commissioning call
+    Determine how much local clusters passed to SimpleCommissioningStart
+    might be preprocessed for fast matching
 */
+#define LOCAL_CLUSTERS_LIST_LEN \
+  EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_LOCAL_CLUSTERS_LIST_LEN
 
-typedef struct DeviceCommissioningClusters {
-  /// Clusters list
-  const uint16_t *clusters;
-  /// Device's endpoint
-  uint8_t ep;
-  /// Lenght of the clusters list
-  uint8_t clusters_arr_len;
-  /// Network index of current endpoint
-  uint8_t network_index;
-  /// flag whether should be used server clusters
-  /// from an Identify Query response or client ones
-  bool is_server;
-} DevCommClusters_t;
+/*! \define DISCOVERY_WINDOW
 
-/*! \typedef struct MatchDescriptorReq
-    \brief Match Descriptor Request structure
+    Determine how much queued remote devices might be discovered
+    and bound at the same time
+*/
+#define DISCOVERY_WINDOW \
+  EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_DISCOVERY_WINDOW
 
-    When a device that sent Identify Query gets Identify
-    Query Responses, we need information listed below
-    for further Binding state
+/*! \define DESCRIPTOR_CACHE_SIZE
+
+    Determine how much remote endpoints' simple descriptors are kept
+    in tokens, 0 disables the cache
 */
-typedef struct MatchDescriptorReq {
-  /// Node's clusters list
-  uint16_t source_cl_arr[INCOMING_DEVICE_CLUSTERS_LIST_LEN];
-  /// Node's clusters list length
-  uint8_t source_cl_arr_len;
-  /// Node's short ID
-  EmberNodeId source;
-  /// Node's EUI64 (uint8_t[EUI64_SIZE] type)
-  EmberEUI64 source_eui64;
-  /// Node's endpoint
-  uint8_t source_ep;
-} MatchDescriptorReq_t;
+#define DESCRIPTOR_CACHE_SIZE \
+  EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_DESCRIPTOR_CACHE
+
+/*! \define IDENTIFY_QUIET_PERIOD
+
+    Determine after how long without a new Identify Query response
+    (in milliseconds) the responses window closes, 0 keeps the window
+    fixed
+*/
+#define IDENTIFY_QUIET_PERIOD \
+  EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_IDENTIFY_QUIET_PERIOD
+
+/*! \define IDENTIFY_WINDOW_LIMIT
+
+    Determine how long (in milliseconds) after the Identify Query
+    the responses window might be kept open by responses still coming
+*/
+#define IDENTIFY_WINDOW_LIMIT \
+  EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_IDENTIFY_WINDOW_LIMIT
+
+/*! \define RUN_STEPS_BUDGET
+
+    Determine how much state machine transitions might run in one call
+    of the plugin's event handler, 1 yields to the stack after every one
+*/
+#define RUN_STEPS_BUDGET \
+  EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_RUN_STEPS_BUDGET
+
+/*! \define RUN_TIME_BUDGET
+
+    Determine how long (in milliseconds) the plugin's event handler might
+    keep running transitions, 0 limits them by RUN_STEPS_BUDGET only
+*/
+#define RUN_TIME_BUDGET \
+  EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_RUN_TIME_BUDGET
+
+/*! \define CONCURRENT_SESSIONS
+
+    Determine how much commissioning sessions (each one on its own
+    endpoint) might run at the same time
+*/
+#define CONCURRENT_SESSIONS \
+  EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_SESSIONS
+
+/*! \define SESSION_ENDPOINTS
+
+    Determine how much local endpoint descriptors (endpoint, clusters and
+    role) a session might match every remote device against
+*/
+#define SESSION_ENDPOINTS \
+  EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_SESSION_ENDPOINTS
+
+/*! \define REPORTING_WINDOW
+
+    Determine how much Configure Reporting requests of a session might
+    await their responses at the same time, 0 disables reporting
+    configuration after binding
+*/
+#define REPORTING_WINDOW \
+  EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_REPORTING_WINDOW
+
+/*! \define REPORTING_RECORDS
+
+    Number of a session's records of Configure Reporting requests
+    awaiting their responses, one at least for the array not to be empty
+*/
+#define REPORTING_RECORDS ((REPORTING_WINDOW > 0) ? REPORTING_WINDOW : 1)
+
+/*! \define IDENTIFY_POLL_PERIOD
+
+    Determine how often (in milliseconds) a session collecting Identify
+    Query responses looks for the remotes queued since its last run. The
+    responses callback does not wake the state machine up, it might run in
+    another context
+*/
+#define IDENTIFY_POLL_PERIOD 20
+
+/*! \define QUEUE_SIZE
+
+    Determine how much remote devices' responses a session might queue
+*/
+#define QUEUE_SIZE EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_REMOTES_QUEUE
+
+/*! \define QUEUE_SLOTS
+
+    QUEUE_SIZE rounded up to a power of two, the remotes queue wraps its
+    indices with a mask
+*/
+#define QUEUE_SLOTS                                                      \
+  (QUEUE_SIZE <= 1    ? 1                                                \
+   : QUEUE_SIZE <= 2  ? 2                                                \
+   : QUEUE_SIZE <= 4  ? 4                                                \
+   : QUEUE_SIZE <= 8  ? 8                                                \
+   : QUEUE_SIZE <= 16 ? 16                                               \
+   : QUEUE_SIZE <= 32 ? 32                                               \
+   : QUEUE_SIZE <= 64 ? 64                                               \
+   : QUEUE_SIZE <= 128 ? 128                                             \
+   : QUEUE_SIZE <= 256 ? 256                                             \
+   : QUEUE_SIZE <= 512 ? 512                                             \
+   : QUEUE_SIZE <= 1024 ? 1024                                           \
+   : QUEUE_SIZE <= 2048 ? 2048                                           \
+                        : 4096)
+
+/*! \typedef QueueIndex_t
+    \brief Position in the remotes queue and in its recent remotes
+
+    Queues up to 127 remotes (MCU builds) keep 8-bit indices, longer
+    ones (hosts commissioning whole buildings) take 16-bit indices
+*/
+#if QUEUE_SIZE > 127
+typedef uint16_t QueueIndex_t;
+#define QUEUE_INDEX_MAX 0xFFFF
+#else
+typedef uint8_t QueueIndex_t;
+#define QUEUE_INDEX_MAX 0xFF
+#endif
+
+/*! \define RECENT_REMOTES
+
+    Remotes remembered for dropping repeated Identify Query responses:
+    the live queue and as much remotes processed before
+*/
+#define RECENT_REMOTES (2 * QUEUE_SIZE)
+
+/*! \define RECENT_SLOTS
+
+    Slots of the recent remotes' hash index: 2 * RECENT_REMOTES rounded up
+    to a power of two, so at least a half of them is kept empty and
+    the index wraps with RECENT_SLOT_MASK
+*/
+#define RECENT_SLOTS (4 * QUEUE_SLOTS)
+#define RECENT_SLOT_MASK (RECENT_SLOTS - 1)
+
+/*! \typedef enum LocalRoles
+    \brief Bit flags of the roles a local cluster is bound in
+
+    Client clusters are bound to remotes' server (in) clusters, server
+    clusters to remotes' client (out) ones
+*/
+typedef enum LocalRoles {
+  SC_ROLE_CLIENT = 0x01,  //!< Local client cluster
+  SC_ROLE_SERVER = 0x02   //!< Local server cluster
+} LocalRole_t;
+
+/*! \typedef struct ClusterMatcher
+    \brief Local clusters prepared for matching
 
-/*! \typedef struct RemoteSkipClusters
-    \brief Remote skip clusters structure
-    that help to skip already binded or currently not represented
-    clusters on the device
+    Deduplicated copy of the local client and server clusters lists and
+    an open addressing set over it, so a remote cluster is looked up in
+    about one probe. Both lists together are at most LOCAL_CLUSTERS_LIST_LEN
+    long
+*/
+typedef struct ClusterMatcher {
+  /// Storage for the deduplicated clusters
+  uint16_t unique_clusters[LOCAL_CLUSTERS_LIST_LEN];
+  /// Roles (LocalRole_t flags) of every cluster of unique_clusters
+  uint8_t roles[LOCAL_CLUSTERS_LIST_LEN];
+  /// Positions in unique_clusters by cluster ID hash, 0xFF for empty slots
+  uint8_t slots[4 * LOCAL_CLUSTERS_LIST_LEN];
+  /// Number of slots in use less one (a power of two less one)
+  uint16_t slot_mask;
+  /// Number of clusters in unique_clusters
+  uint8_t len;
+  /// Roles (LocalRole_t flags) of all clusters
+  uint8_t present_roles;
+} ClusterMatcher_t;
+
+/*! \define LOCAL_CLUSTERS_MASK_WORDS
+
+    Number of 32-bit words holding a bit for every cluster position of
+    a local endpoint descriptor's matcher
+*/
+#define LOCAL_CLUSTERS_MASK_WORDS ((LOCAL_CLUSTERS_LIST_LEN + 31) / 32)
+
+/*! \define MATCH_RESULTS_CACHE_SIZE
 
-    In the current implementation up to 16 clusters in a list might
-    be processed
+    Determine how much remote device models' match results are kept
+    during a session. Results are looked up by the descriptor's 32-bit
+    fingerprint, profile, device ID and lists lengths, the lists are not
+    kept to be compared. Two models with the same lengths whose lists
+    differ but collide in the fingerprint (one in 2^32 such pairs) share
+    a result, so the second one gets the first one's clusters bound
 */
-typedef struct RemoteSkipClusters {
-  /// bit representation of which cluster must be skipped
-  /// in the remote clusters list
-  uint16_t skip_clusters;
-  /// length of the bit mask
-  uint16_t len;
-} RemoteSkipClusters_t;
+#define MATCH_RESULTS_CACHE_SIZE \
+  EMBER_AF_PLUGIN_SIMPLE_COMMISSIONING_INITIATOR_MATCH_RESULTS_CACHE
+
+/*! \typedef struct MatchResult
+    \brief Supported clusters of a remote device model
+
+    A model is told by the fingerprint of its simple descriptor
+    (profile, device ID and both cluster lists)
+*/
+typedef struct MatchResult {
+  /// Descriptor's fingerprint
+  uint32_t fingerprint;
+  /// Descriptor's profile ID
+  uint16_t profile_id;
+  /// Descriptor's device ID
+  uint16_t device_id;
+  /// Descriptor's in clusters count
+  uint8_t in_count;
+  /// Descriptor's out clusters count
+  uint8_t out_count;
+  /// Supported clusters, a bit per position of the matcher's clusters
+  uint32_t clusters[LOCAL_CLUSTERS_MASK_WORDS];
+} MatchResult_t;
+
+/*! \typedef struct MatchResults
+    \brief Match results of the models met during the session
+
+    Results depend on the local clusters list, so they live as long
+    as the session
+*/
+typedef struct MatchResults {
+  /// Cached results
+  MatchResult_t results[MATCH_RESULTS_CACHE_SIZE];
+  /// Number of cached results
+  uint8_t count;
+  /// Result to be replaced next when all of them are in use
+  uint8_t next;
+} MatchResults_t;
+
+/*! \typedef struct DevicesCommissioningClusters
+    \brief Device's clusters for commissioning
+
+    Storage for device's endpoint and its client and server clusters
+    for current commissioning call, one per local endpoint descriptor
+    of the session
+*/
+
+typedef struct DeviceCommissioningClusters {
+  /// Device's endpoint
+  uint8_t ep;
+  /// Client and server clusters lists prepared for matching remote
+  /// clusters
+  ClusterMatcher_t matcher;
+  /// Match results of the remote device models met so far
+  MatchResults_t match_results;
+} DevCommClusters_t;
 
 /*! \typedef enum CommissioningStates
     \brief Commissioning States
@@ -81,6 +285,8 @@ typedef enum CommissioningStates {
   SC_EZ_DISCOVER,         //!< Discover clusters
   SC_EZ_MATCH,            //!< Matching state
   SC_EZ_BIND,             //!< Cluster binding
+  SC_EZ_REPORT,           //!< Attribute reporting configuration
+  SC_EZ_STATES_COUNT,     //!< Number of states, not a state
   SC_EZ_UNKNOWN = 255     //!< Error
 } CommissioningState_t;
 
@@ -105,28 +311,263 @@ typedef enum CommissioningEvents {
   SC_EZEV_CHECK_QUEUE,
   SC_EZEV_BINDING_DONE,
   SC_EZEV_QUEUE_EMPTY,
+  SC_EZEV_CONFIGURE_REPORTING,
+  SC_EZEV_REPORTING_DONE,
+  SC_EZEV_EVENTS_COUNT,  //!< Number of events, not an event
   SC_EZEV_UNKNOWN = 255
 } CommissioningEvent_t;
 
-/*! \typedef struct StateMachineTask
-    \brief State Machine Task definition
+/*! \typedef StateMachineHandler
+    \brief State Machine handler
 
-    Every task describes particular state, event and
-    handler that has to be called
+    Handles particular state and event, returns the next state and sets
+    the next event inside itself
 */
-typedef struct StateMachineTask {
-  CommissioningState_t state;
-  CommissioningEvent_t event;
-  CommissioningState_t (*handler)(void);
-} SMTask_t;
+typedef CommissioningState_t (*SMHandler_t)(void);
 
 /*! \typedef struct StateMachineNextState
 
-    Typedef for storing the next state for the state machine
+    Typedef for storing the next state for the state machine. State and
+    event are kept in a byte each, every instance of the state machine
+    carries one
 */
 typedef struct StateMachineNextState {
-  CommissioningState_t next_state;
-  CommissioningEvent_t next_event;
+  /// Next state (CommissioningState_t)
+  uint8_t next_state;
+  /// Next event (CommissioningEvent_t)
+  uint8_t next_event;
 } SMNext_t;
 
+/*! \define REMOTE_CLUSTERS_MASK_WORDS
+
+    Number of 32-bit words holding a bit for every local cluster of
+    a session, LOCAL_CLUSTERS_MASK_WORDS per local endpoint descriptor
+*/
+#define REMOTE_CLUSTERS_MASK_WORDS \
+  (SESSION_ENDPOINTS * LOCAL_CLUSTERS_MASK_WORDS)
+
+/// Bits of a local endpoint descriptor and of a whole remote's mask
+#define LOCAL_CLUSTERS_MASK_BITS (32 * LOCAL_CLUSTERS_MASK_WORDS)
+#define REMOTE_CLUSTERS_MASK_BITS (32 * REMOTE_CLUSTERS_MASK_WORDS)
+
+/*! \typedef struct RemoteClusters
+    \brief Supported clusters of a remote device
+
+    Every supported cluster is one of the session's local clusters, so
+    the remote keeps a bit per local cluster position instead of cluster
+    IDs. Every local endpoint descriptor takes LOCAL_CLUSTERS_MASK_WORDS
+    words, in the session's order. Bits of already bound or otherwise
+    skipped clusters are cleared as the remote is processed
+*/
+typedef struct RemoteClusters {
+  /// Bits of the clusters still to be processed
+  uint32_t mask[REMOTE_CLUSTERS_MASK_WORDS];
+  /// Number of set bits when matched, at most
+  /// INCOMING_DEVICE_CLUSTERS_LIST_LEN
+  uint8_t count;
+} RemoteClusters_t;
+
+/*! \typedef struct StateMachineContext
+    \brief State machine instance
+
+    The commissioning session and every remote device processed
+    in the pipeline run their own instance of the state machine.
+    All instances share the plugin's event, which is scheduled for
+    the earliest due transition
+*/
+typedef struct StateMachineContext {
+  /// Millisecond tick the transition is due at
+  uint32_t time_to_execute;
+  /// Transition to run on the next wake up
+  SMNext_t transition;
+  /// Whether the transition is scheduled at all
+  bool scheduled;
+} SMContext_t;
+
+/*! \typedef enum RemoteStages
+    \brief Pipeline stage of a queued remote device
+*/
+typedef enum RemoteStages {
+  SC_REMOTE_NEW = 0,    //!< Just queued, not taken by the session yet
+  SC_REMOTE_QUEUED,     //!< Waiting for a free discovery window slot
+  SC_REMOTE_IN_FLIGHT,  //!< Discovery/binding in progress
+  SC_REMOTE_DONE        //!< Processed, waiting to be popped
+} RemoteStage_t;
+
+/*! \typedef enum RemoteLookups
+    \brief Bit flags of a queued remote's lookups
+
+    Simple descriptor and IEEE address lookups might be in flight at
+    the same time, binding waits for both of them. Configure Reporting
+    requests follow binding. An EUI64 taken from a descriptor cached by
+    short ID is asked for anyway, the short ID might belong to another
+    remote by now
+*/
+typedef enum RemoteLookups {
+  SC_LOOKUP_DESCRIPTOR_PENDING = 0x01,  //!< Simple Descriptor request sent
+  SC_LOOKUP_EUI64_PENDING = 0x02,       //!< IEEE address request sent
+  SC_LOOKUP_EUI64_KNOWN = 0x04,         //!< source_eui64 is valid
+  SC_LOOKUP_EUI64_LOCAL_DONE = 0x08,    //!< Stack tables were searched
+  SC_LOOKUP_DESCRIPTOR_CACHED = 0x10,   //!< Descriptor cache was searched
+  SC_LOOKUP_REPORTING_PENDING = 0x20,   //!< Configure Reporting sent
+  SC_LOOKUP_EUI64_UNVERIFIED = 0x40     //!< source_eui64 is the cache's
+} RemoteLookup_t;
+
+/*! \typedef struct MatchDescriptorReq
+    \brief Match Descriptor Request structure
+
+    When a device that sent Identify Query gets Identify
+    Query Responses, we need information listed below
+    for further Binding state
+
+    Fields go from the widest alignment down, so the only padding is the
+    tails of sm (one byte), clusters (three bytes, after count) and of
+    the struct itself (two bytes). Queued remotes get only their header (ID,
+    stage, lookups and state machine) initialized, the other fields are
+    written before they are read
+*/
+typedef struct MatchDescriptorReq {
+  /// Node's own state machine instance
+  SMContext_t sm;
+  /// Millisecond tick the Simple Descriptor request was sent at
+  uint32_t descriptor_sent_ms;
+  /// Millisecond tick the IEEE address request was sent at
+  uint32_t eui64_sent_ms;
+  /// Node's supported clusters
+  RemoteClusters_t clusters;
+  /// Node's short ID
+  EmberNodeId source;
+  /// Node's EUI64 (uint8_t[EUI64_SIZE] type)
+  EmberEUI64 source_eui64;
+  /// Node's endpoint
+  uint8_t source_ep;
+  /// Node's pipeline stage (RemoteStage_t)
+  uint8_t stage;
+  /// Node's lookups state (RemoteLookup_t flags)
+  uint8_t lookups;
+  /// Node's Configure Reporting requests awaiting their responses
+  uint8_t reporting_pending;
+} MatchDescriptorReq_t;
+
+/*! \typedef struct ReportingRecord
+    \brief Configure Reporting request awaiting its response
+
+    Every request times out on its own, a remote's requests might be
+    sent as the reporting window gets free
+*/
+typedef struct ReportingRecord {
+  /// Millisecond tick the request was sent at
+  uint32_t sent_ms;
+  /// Remote the request was sent to, NULL for a free record
+  MatchDescriptorReq_t *remote;
+  /// Cluster the request configures reporting of
+  uint16_t cluster_id;
+} ReportingRecord_t;
+
+/*! \typedef struct RingBuffer
+    \brief Single-producer/single-consumer ring buffer of remote devices'
+    descriptors
+
+    Only the producer (Identify Query responses) moves tail and only the
+    consumer (state machine) moves head. The producer just fills a slot
+    and pushes it, the consumer finds it on its next run, so the two might
+    run in different contexts without a lock. Both indices run freely and
+    are masked on access, tail - head is the number of queued descriptors
+*/
+typedef struct RingBuffer {
+  /// Power of two slots
+  MatchDescriptorReq_t *buffer;
+  /// Free running index of the top descriptor, moved by the consumer
+  QueueIndex_t head;
+  /// Free running index of the next slot to fill, moved by the producer
+  QueueIndex_t tail;
+  /// Number of slots less one
+  QueueIndex_t mask;
+  /// Most descriptors queued at once, not more than the number of slots
+  QueueIndex_t capacity;
+} RingBuffer_t;
+
+/*! \typedef struct RecentRemotes
+    \brief Remotes seen during the session
+
+    FIFO of (short ID, endpoint) keys with an open addressing index over
+    it. Remotes leave the queue in the order they enter it, so the oldest
+    key evicted from the full FIFO never belongs to a queued remote.
+    The producer's own, the consumer starts it over by moving the queue
+    to a new generation
+*/
+typedef struct RecentRemotes {
+  /// Keys in the order they were added
+  uint32_t keys[RECENT_REMOTES];
+  /// Positions in keys by hash, RECENT_SLOT_EMPTY for empty slots
+  QueueIndex_t slots[RECENT_SLOTS];
+  /// Position of the oldest key
+  QueueIndex_t oldest;
+  /// Number of keys
+  QueueIndex_t count;
+  /// Queue generation the keys were added in
+  uint8_t generation;
+} RecentRemotes_t;
+
+/*! \typedef struct MatchDescriptorQueue
+    \brief Remote devices queue of a session
+*/
+typedef struct MatchDescriptorQueue {
+  /// Storage of the queued remotes, QUEUE_SIZE of the slots are used
+  MatchDescriptorReq_t data[QUEUE_SLOTS];
+  /// Ring buffer over data
+  RingBuffer_t internal_data;
+  /// Remotes queued since the queue was opened
+  RecentRemotes_t recent_remotes;
+  /// Local endpoint the queue takes Identify Query responses to, 0 while
+  /// the queue is closed. Set by the consumer, read by the producer
+  uint8_t endpoint;
+  /// Moved on by the consumer every time it opens the queue
+  uint8_t generation;
+} MatchDescriptorQueue_t;
+
+/*! \typedef struct CommissioningSession
+    \brief Commissioning session
+
+    Everything a session started by SimpleCommissioningStart keeps
+    on its own. Every remote is discovered once and matched against all
+    of the session's local endpoint descriptors. Up to CONCURRENT_SESSIONS
+    of them run at the same time on different endpoints (and so possibly
+    different networks), sharing
+    the plugin's event, the binding table and the descriptors cache
+*/
+typedef struct CommissioningSession {
+  /// Session's local endpoint descriptors, the Identify Query is sent
+  /// from the first one's endpoint
+  DevCommClusters_t dev_comm[SESSION_ENDPOINTS];
+  /// Number of local endpoint descriptors
+  uint8_t dev_comm_count;
+  /// Network index of the session's endpoints
+  uint8_t network_index;
+  /// Number of remotes expected to respond, the Identify Query responses
+  /// window stays open until that much are queued. 0 if not known
+  uint16_t expected_remotes;
+  /// Session's own state machine instance
+  SMContext_t sm;
+  /// Remotes responded to the session's Identify Query
+  MatchDescriptorQueue_t queue;
+  /// Millisecond tick the Identify Query responses window closes at
+  uint32_t identify_window_end;
+  /// Millisecond tick responses still coming in might keep the Identify
+  /// Query responses window open till
+  uint32_t identify_window_limit;
+  /// Number of remotes queued since the Identify Query
+  uint16_t identified_remotes;
+  /// Configure Reporting requests of all remotes awaiting their
+  /// responses, reporting_in_flight of them are in use
+  ReportingRecord_t reporting[REPORTING_RECORDS];
+  /// Configure Reporting requests of all remotes awaiting their
+  /// responses, up to REPORTING_WINDOW
+  uint8_t reporting_in_flight;
+  /// Device's attempts for forming or joining a network
+  uint8_t network_access_tries;
+  /// Remotes' service discovery requests the stack refused in a row
+  uint16_t discovery_refusals;
+} CommissioningSession_t;
+
 #endif  // SIMPLE_COMMISSIONING_TYPEDEFS_H